@@ -55,6 +55,7 @@ static inline void crc_init(uint16_t* crcAccum)
 }
 
 
+#ifndef HAVE_CRC_ACCUMULATE_BUFFER
 /**
  * @brief Calculates the CRC16_MCRF4XX checksum on a byte buffer
  *
@@ -89,6 +90,15 @@ static inline void crc_accumulate_buffer(uint16_t *crcAccum, const char *pBuffer
                 crc_accumulate(*p++, crcAccum);
         }
 }
+#else
+/*
+  crc_calculate() and crc_accumulate_buffer() are provided by the
+  application (e.g. table driven or with carry-less multiply). They must
+  give the same result as crc_accumulate() applied byte by byte
+ */
+uint16_t crc_calculate(const uint8_t* pBuffer, uint16_t length);
+void crc_accumulate_buffer(uint16_t *crcAccum, const char *pBuffer, uint16_t length);
+#endif
 
 #if defined(MAVLINK_USE_CXX_NAMESPACE) || defined(__cplusplus)
 }
@@ -542,6 +542,11 @@ MAVLINK_HELPER const mavlink_msg_entry_t *mavlink_get_msg_entry(uint32_t msgid)
         }
         return &mavlink_message_crcs[low];
 }
+#else
+/*
+  provided by the application, e.g. as a table indexed by msgid
+*/
+const mavlink_msg_entry_t *mavlink_get_msg_entry(uint32_t msgid);
 #endif // MAVLINK_GET_MSG_ENTRY
 
 /*
@@ -946,6 +951,33 @@ MAVLINK_HELPER unsigned int mavlink_get_proto_version(uint8_t chan)
 	}
 }
 
+/**
+ * @brief Same as mavlink_parse_char(), with the parser state given explicitly
+ *
+ * rxmsg and status belong to one stream and must not be shared between threads.
+ * status->signing, if set, is used to check signed frames.
+ */
+MAVLINK_HELPER uint8_t mavlink_parse_char_buffer(mavlink_message_t* rxmsg, mavlink_status_t* status, uint8_t c,
+						 mavlink_message_t* r_message, mavlink_status_t* r_mavlink_status)
+{
+    uint8_t msg_received = mavlink_frame_char_buffer(rxmsg, status, c, r_message, r_mavlink_status);
+    if (msg_received == MAVLINK_FRAMING_BAD_CRC ||
+	msg_received == MAVLINK_FRAMING_BAD_SIGNATURE) {
+	    // we got a bad CRC. Treat as a parse failure
+	    _mav_parse_error(status);
+	    status->msg_received = MAVLINK_FRAMING_INCOMPLETE;
+	    status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+	    if (c == MAVLINK_STX)
+	    {
+		    status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+		    rxmsg->len = 0;
+		    mavlink_start_checksum(rxmsg);
+	    }
+	    return 0;
+    }
+    return msg_received;
+}
+
 /**
  * This is a convenience function which handles the complete MAVLink parsing.
  * the function will parse one byte at a time and return the complete packet once
@@ -989,24 +1021,265 @@ MAVLINK_HELPER unsigned int mavlink_get_proto_version(uint8_t chan)
  */
 MAVLINK_HELPER uint8_t mavlink_parse_char(uint8_t chan, uint8_t c, mavlink_message_t* r_message, mavlink_status_t* r_mavlink_status)
 {
-    uint8_t msg_received = mavlink_frame_char(chan, c, r_message, r_mavlink_status);
-    if (msg_received == MAVLINK_FRAMING_BAD_CRC ||
-	msg_received == MAVLINK_FRAMING_BAD_SIGNATURE) {
-	    // we got a bad CRC. Treat as a parse failure
-	    mavlink_message_t* rxmsg = mavlink_get_channel_buffer(chan);
-	    mavlink_status_t* status = mavlink_get_channel_status(chan);
-	    _mav_parse_error(status);
-	    status->msg_received = MAVLINK_FRAMING_INCOMPLETE;
-	    status->parse_state = MAVLINK_PARSE_STATE_IDLE;
-	    if (c == MAVLINK_STX)
-	    {
-		    status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
-		    rxmsg->len = 0;
-		    mavlink_start_checksum(rxmsg);
-	    }
-	    return 0;
-    }
-    return msg_received;
+    return mavlink_parse_char_buffer(mavlink_get_channel_buffer(chan),
+				     mavlink_get_channel_status(chan),
+				     c, r_message, r_mavlink_status);
+}
+
+/*
+  return a pointer to the first MAVLink 1 or 2 start marker in [p, end),
+  or end. Scans 8 bytes per step with the "has zero byte" word trick
+ */
+MAVLINK_HELPER const uint8_t *_mav_find_stx(const uint8_t *p, const uint8_t *end)
+{
+	const uint64_t ones = 0x0101010101010101ULL;
+	const uint64_t highs = 0x8080808080808080ULL;
+	while (end - p >= 8) {
+		uint64_t w, a, b;
+		memcpy(&w, p, 8);
+		a = w ^ (ones * MAVLINK_STX);
+		b = w ^ (ones * MAVLINK_STX_MAVLINK1);
+		if ((((a - ones) & ~a) | ((b - ones) & ~b)) & highs) {
+			break;
+		}
+		p += 8;
+	}
+	while (p < end && *p != MAVLINK_STX && *p != MAVLINK_STX_MAVLINK1) {
+		p++;
+	}
+	return p;
+}
+
+/*
+  fill a frame view from a message reassembled in the channel buffer
+ */
+MAVLINK_HELPER void _mav_frame_view_from_message(const mavlink_message_t *msg, mavlink_frame_view_t *view)
+{
+	view->payload = (const uint8_t *)_MAV_PAYLOAD(msg);
+	view->signature = (msg->incompat_flags & MAVLINK_IFLAG_SIGNED) ? msg->signature : NULL;
+	view->entry = mavlink_get_msg_entry(msg->msgid);
+	view->msg = msg;
+	view->msgid = msg->msgid;
+	view->checksum = msg->checksum;
+	view->magic = msg->magic;
+	view->len = msg->len;
+	view->incompat_flags = msg->incompat_flags;
+	view->compat_flags = msg->compat_flags;
+	view->seq = msg->seq;
+	view->sysid = msg->sysid;
+	view->compid = msg->compid;
+}
+
+/**
+ * @brief Same as mavlink_parse_buffer(), with the parser state given explicitly
+ *
+ * rxmsg and status belong to one stream (see mavlink_parse_char_buffer()), so
+ * streams parsed on different threads do not share anything.
+ */
+MAVLINK_HELPER uint8_t mavlink_parse_buffer_state(mavlink_message_t *rxmsg, mavlink_status_t *status,
+						  const uint8_t **pbuf, const uint8_t *end, mavlink_frame_view_t *view)
+{
+	const uint8_t *p = *pbuf;
+	const uint8_t *start = p;
+	const uint8_t *bad_end = p;	// end of the last frame with a bad CRC
+
+	// finish a frame left over from the previous read
+	while (p < end && status->parse_state > MAVLINK_PARSE_STATE_IDLE) {
+		if (mavlink_parse_char_buffer(rxmsg, status, *p++, NULL, NULL) == MAVLINK_FRAMING_OK) {
+			*pbuf = p;
+			_mav_frame_view_from_message(rxmsg, view);
+			return MAVLINK_FRAMING_OK;
+		}
+		if (status->parse_state <= MAVLINK_PARSE_STATE_GOT_STX) {
+			// the left over start was false (e.g. a marker in the tail of a
+			// corrupted frame): its bytes here may hold real frames, rescan them
+			status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+			p = start;
+			break;
+		}
+	}
+
+	while ((p = _mav_find_stx(p, end)) < end) {
+		const uint8_t v1 = (*p == MAVLINK_STX_MAVLINK1);
+		const uint8_t header_len = v1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 : MAVLINK_NUM_HEADER_BYTES;
+		const mavlink_msg_entry_t *e;
+		const uint8_t *ck;
+		uint8_t len, incompat_flags;
+		uint32_t msgid;
+		uint16_t frame_len, crc;
+
+		if (end - p < header_len) {
+			if (p < bad_end) {
+				// mavlink_parse_char() skips a marker inside a frame with a bad
+				// CRC, so it is not carried over to the next read either
+				p++;
+				continue;
+			}
+			break;
+		}
+
+		len = p[1];
+		incompat_flags = v1 ? 0 : p[2];
+		msgid = v1 ? p[5] : (p[7] | ((uint32_t)p[8] << 8) | ((uint32_t)p[9] << 16));
+		e = mavlink_get_msg_entry(msgid);
+		if (e == NULL || (incompat_flags & ~MAVLINK_IFLAG_MASK) != 0 ||
+#if (MAVLINK_MAX_PAYLOAD_LEN < 255)
+		    len > MAVLINK_MAX_PAYLOAD_LEN ||
+#endif
+		    (v1 && (len < e->min_msg_len || len > e->max_msg_len))) {
+			// not a frame start, resync on the next marker
+			p++;
+			continue;
+		}
+
+		frame_len = header_len + len + MAVLINK_NUM_CHECKSUM_BYTES +
+			((incompat_flags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+		if (end - p < frame_len) {
+			if (p < bad_end) {
+				p++;
+				continue;
+			}
+			break;
+		}
+
+		crc = crc_calculate(p + 1, header_len - 1 + len);
+		crc_accumulate(e->crc_extra, &crc);
+		ck = p + header_len + len;
+		if (ck[0] != (crc & 0xFF) || ck[1] != (crc >> 8)) {
+			_mav_parse_error(status);
+			if (p + frame_len > bad_end) {
+				bad_end = p + frame_len;
+			}
+			p++;
+			continue;
+		}
+
+		if (status->signing) {
+			if (incompat_flags & MAVLINK_IFLAG_SIGNED) {
+				const uint8_t *frame_end = p + frame_len;
+				uint8_t result = MAVLINK_FRAMING_INCOMPLETE;
+				while (p < frame_end) {
+					result = mavlink_parse_char_buffer(rxmsg, status, *p++, NULL, NULL);
+				}
+				if (result == MAVLINK_FRAMING_OK) {
+					*pbuf = p;
+					_mav_frame_view_from_message(rxmsg, view);
+					return MAVLINK_FRAMING_OK;
+				}
+				continue;
+			}
+			if (status->signing->accept_unsigned_callback == NULL ||
+			    !status->signing->accept_unsigned_callback(status, msgid)) {
+				_mav_parse_error(status);
+				p += frame_len;
+				continue;
+			}
+		}
+
+		view->payload = p + header_len;
+		view->signature = (incompat_flags & MAVLINK_IFLAG_SIGNED) ? ck + MAVLINK_NUM_CHECKSUM_BYTES : NULL;
+		view->entry = e;
+		view->msg = NULL;
+		view->msgid = msgid;
+		view->checksum = crc;
+		view->magic = p[0];
+		view->len = len;
+		view->incompat_flags = incompat_flags;
+		view->compat_flags = v1 ? 0 : p[3];
+		view->seq = p[v1 ? 2 : 4];
+		view->sysid = p[v1 ? 3 : 5];
+		view->compid = p[v1 ? 4 : 6];
+
+		// same bookkeeping as mavlink_frame_char_buffer()
+		if (v1) {
+			status->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+		} else {
+			status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+		}
+		status->current_rx_seq = view->seq;
+		if (status->packet_rx_success_count == 0) status->packet_rx_drop_count = 0;
+		status->packet_rx_success_count++;
+
+		*pbuf = p + frame_len;
+		return MAVLINK_FRAMING_OK;
+	}
+
+	// a frame split across reads, continued by the next call
+	while (p < end) {
+		mavlink_parse_char_buffer(rxmsg, status, *p++, NULL, NULL);
+	}
+	*pbuf = end;
+	return MAVLINK_FRAMING_INCOMPLETE;
+}
+
+/**
+ * @brief Find the next good frame in a whole receive buffer (e.g. one UDP datagram)
+ *
+ * Unlike mavlink_parse_char() this does not run the state machine per byte:
+ * it jumps to the next start marker, checks the header against the message
+ * table, computes the CRC over the contiguous frame and returns a view of
+ * it without copying. A frame start must have a known msgid, and a
+ * MAVLink 1 frame a length the message can have (MAVLink 2 payloads may be
+ * truncated or carry unknown extensions, so only the CRC decides for them).
+ *
+ * Frames that are not complete in the buffer go to mavlink_parse_char() on
+ * the same channel, and the next call continues them byte by byte, so a
+ * clean stream split at arbitrary points parses the same as with mavlink_parse_char().
+ * If the continued frame turns out bad, the bytes of this call are scanned
+ * again from the start, so a false marker left at the end of one datagram
+ * does not swallow a good frame in the next one.
+ * Signed frames are also checked by the bytewise parser when signing is set up.
+ *
+ * @param chan     ID of the channel, shared with mavlink_parse_char()
+ * @param pbuf     in: where to start, out: where to continue
+ * @param end      end of the received bytes
+ * @param view     the frame found
+ * @return MAVLINK_FRAMING_OK if view is filled, MAVLINK_FRAMING_INCOMPLETE when the buffer is used up
+ *
+ * @code
+ * const uint8_t *p = buf;
+ * mavlink_frame_view_t frame;
+ * while (mavlink_parse_buffer(chan, &p, buf + n, &frame)) {
+ *   if (frame.msgid == MAVLINK_MSG_ID_HEARTBEAT) ...
+ * }
+ * @endcode
+ */
+MAVLINK_HELPER uint8_t mavlink_parse_buffer(uint8_t chan, const uint8_t **pbuf, const uint8_t *end,
+					    mavlink_frame_view_t *view)
+{
+	return mavlink_parse_buffer_state(mavlink_get_channel_buffer(chan), mavlink_get_channel_status(chan),
+					  pbuf, end, view);
+}
+
+/**
+ * @brief Copy a frame view into a message, as mavlink_parse_char() would have returned it
+ */
+MAVLINK_HELPER void mavlink_frame_view_to_message(const mavlink_frame_view_t *view, mavlink_message_t *msg)
+{
+	if (view->msg != NULL) {
+		memcpy(msg, view->msg, sizeof(mavlink_message_t));
+		return;
+	}
+
+	msg->checksum = view->checksum;
+	msg->magic = view->magic;
+	msg->len = view->len;
+	msg->incompat_flags = view->incompat_flags;
+	msg->compat_flags = view->compat_flags;
+	msg->seq = view->seq;
+	msg->sysid = view->sysid;
+	msg->compid = view->compid;
+	msg->msgid = view->msgid;
+	memcpy(_MAV_PAYLOAD_NON_CONST(msg), view->payload, view->len);
+	// zero-fill the packet to cope with short incoming packets
+	if (view->len < view->entry->max_msg_len) {
+		memset(&_MAV_PAYLOAD_NON_CONST(msg)[view->len], 0, view->entry->max_msg_len - view->len);
+	}
+	msg->ck[0] = (uint8_t)(view->checksum & 0xFF);
+	msg->ck[1] = (uint8_t)(view->checksum >> 8);
+	if (view->signature != NULL) {
+		memcpy(msg->signature, view->signature, MAVLINK_SIGNATURE_BLOCK_LEN);
+	}
 }
 
 /**
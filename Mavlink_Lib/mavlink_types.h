@@ -301,6 +301,28 @@ typedef struct __mavlink_msg_entry {
 	uint8_t target_component_ofs; // payload offset to target_component, or 0
 } mavlink_msg_entry_t;
 
+/*
+  a frame found by mavlink_parse_buffer(). Points into the caller's
+  receive buffer, so it is only valid until that buffer is reused. A
+  frame that was split across reads is reassembled in the channel
+  buffer instead, then msg points to it
+ */
+typedef struct __mavlink_frame_view {
+	const uint8_t *payload;          ///< len payload bytes, not zero-filled
+	const uint8_t *signature;        ///< signature block, or NULL if unsigned
+	const mavlink_msg_entry_t *entry; ///< table entry of msgid
+	const mavlink_message_t *msg;    ///< reassembled message, or NULL
+	uint32_t msgid;
+	uint16_t checksum;
+	uint8_t magic;
+	uint8_t len;
+	uint8_t incompat_flags;
+	uint8_t compat_flags;
+	uint8_t seq;
+	uint8_t sysid;
+	uint8_t compid;
+} mavlink_frame_view_t;
+
 /*
   incompat_flags bits
  */
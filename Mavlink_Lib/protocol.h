@@ -60,7 +60,14 @@
 						     mavlink_message_t* r_message, 
 						     mavlink_status_t* r_mavlink_status);
     MAVLINK_HELPER uint8_t mavlink_frame_char(uint8_t chan, uint8_t c, mavlink_message_t* r_message, mavlink_status_t* r_mavlink_status);
+    MAVLINK_HELPER uint8_t mavlink_parse_char_buffer(mavlink_message_t* rxmsg, mavlink_status_t* status, uint8_t c,
+                                                     mavlink_message_t* r_message, mavlink_status_t* r_mavlink_status);
     MAVLINK_HELPER uint8_t mavlink_parse_char(uint8_t chan, uint8_t c, mavlink_message_t* r_message, mavlink_status_t* r_mavlink_status);
+    MAVLINK_HELPER uint8_t mavlink_parse_buffer_state(mavlink_message_t *rxmsg, mavlink_status_t *status,
+                                                      const uint8_t **pbuf, const uint8_t *end, mavlink_frame_view_t *view);
+    MAVLINK_HELPER uint8_t mavlink_parse_buffer(uint8_t chan, const uint8_t **pbuf, const uint8_t *end,
+                                                mavlink_frame_view_t *view);
+    MAVLINK_HELPER void mavlink_frame_view_to_message(const mavlink_frame_view_t *view, mavlink_message_t *msg);
     MAVLINK_HELPER uint8_t put_bitfield_n_by_index(int32_t b, uint8_t bits, uint8_t packet_index, uint8_t bit_index,
                                uint8_t* r_bit_index, uint8_t* buffer);
     MAVLINK_HELPER const mavlink_msg_entry_t *mavlink_get_msg_entry(uint32_t msgid);
@@ -0,0 +1,116 @@
+// CRC-16/MCRF4XX кадров MAVLink: slice-by-8 и свёртка PCLMULQDQ против побайтного
+// crc_accumulate. Сначала проверка совпадения до бита (все длины вокруг порогов свёртки
+// 32 и MAVLINK_CRC_FOLD_MIN, сдвиги начала, случайные длины и начальные crc), затем скорость
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "MavlinkCrc.h"
+
+static std::mt19937 rng(47);
+
+// Результаты замеров складываются сюда, чтобы вызовы не выбросил оптимизатор
+static volatile uint16_t sink;
+
+// Эталон: побайтный crc_accumulate из checksum.h
+static uint16_t reference(uint16_t crc, const uint8_t* data, size_t size)
+{
+    while (size--)
+        crc_accumulate(*data++, &crc);
+    return crc;
+}
+
+typedef uint16_t (*CrcFunction)(uint16_t, const uint8_t*, size_t);
+
+static uint16_t viaCrcCalculate(uint16_t, const uint8_t* data, size_t size)
+{
+    return crc_calculate(data, static_cast<uint16_t>(size));
+}
+
+struct Implementation
+{
+    const char* name;
+    CrcFunction function;
+    bool fixedInit;     // crc_calculate всегда начинает с X25_INIT_CRC
+};
+
+static size_t checkImplementation(const Implementation& impl, const std::vector<uint8_t>& buffer)
+{
+    size_t checks = 0, bad = 0;
+    auto check = [&](uint16_t crc, size_t offset, size_t size) {
+        if (impl.fixedInit) crc = X25_INIT_CRC;
+        const uint8_t* data = buffer.data() + offset;
+        if (impl.function(crc, data, size) != reference(crc, data, size))
+        {
+            if (bad < 5) printf("  %s: mismatch at offset %zu, size %zu, crc %04x\n", impl.name, offset, size, crc);
+            bad++;
+        }
+        checks++;
+    };
+
+    // Все длины до 300 (пороги 32 и 64, хвосты после блоков по 16 и 8 байт) при каждом
+    // сдвиге начала 0..15 и нескольких начальных crc
+    const uint16_t inits[] = {X25_INIT_CRC, 0x0000, 0x1234, static_cast<uint16_t>(rng())};
+    for (uint16_t crc : inits)
+        for (size_t offset = 0; offset < 16; ++offset)
+            for (size_t size = 0; size <= 300; ++size)
+                check(crc, offset, size);
+
+    // Случайные длины до полного кадра и дальше, случайные начальные crc
+    for (int i = 0; i < 200000; ++i)
+        check(static_cast<uint16_t>(rng()), rng() % 16, rng() % 4096);
+
+    printf("%-28s %zu checks, %zu mismatches%s\n", impl.name, checks, bad, bad ? "  MISMATCH" : "");
+    return bad;
+}
+
+int main()
+{
+    std::vector<uint8_t> buffer(16 + 4096);
+    for (uint8_t& b : buffer) b = static_cast<uint8_t>(rng());
+
+    std::vector<Implementation> implementations = {
+        {"crcMcrf4xxSlice8", crcMcrf4xxSlice8, false},
+        {"crcMcrf4xxUpdate", crcMcrf4xxUpdate, false},
+        {"crc_calculate", viaCrcCalculate, true},
+    };
+#ifdef HAVE_PCLMUL_KERNELS
+    if (__builtin_cpu_supports("pclmul"))
+        implementations.push_back({"crcMcrf4xxFoldPclmul", crcMcrf4xxFoldPclmul, false});
+    else
+        printf("PCLMULQDQ not supported, crcMcrf4xxFoldPclmul not checked\n");
+#endif
+
+    for (const Implementation& impl : implementations)
+        checkImplementation(impl, buffer);
+
+    // Скорость на длинах кадров: HEARTBEAT, ATTITUDE, MISSION_ITEM_INT, FTP и буфер 4 КБ
+    implementations.insert(implementations.begin(), {"crc_accumulate (bytewise)", reference, false});
+    const size_t sizes[] = {9 + 9, 28 + 9, 37 + 9, 251 + 9, 4096};
+    const size_t bytesPerRun = 64 << 20;
+
+    printf("%-28s", "MB/s");
+    for (size_t size : sizes) printf(" %8zu", size);
+    printf("\n");
+
+    for (const Implementation& impl : implementations)
+    {
+        printf("%-28s", impl.name);
+        for (size_t size : sizes)
+        {
+            size_t runs = bytesPerRun / size;
+            uint16_t crc = X25_INIT_CRC;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < runs; ++r)
+                crc ^= impl.function(crc, buffer.data() + (r & 15), size);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            sink = crc;
+            printf(" %8.0f", runs * size / 1e6 / seconds);
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
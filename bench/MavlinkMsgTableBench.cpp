@@ -0,0 +1,117 @@
+// Поиск сообщения MAVLink: прежнее деление пополам по MAVLINK_MESSAGE_CRCS против таблицы
+// страниц mavlink_get_msg_entry, поиск по имени - деление пополам по MAVLINK_MESSAGE_NAMES
+// против хеша mavlinkMsgEntryByName. Сначала проверка, что оба дают одно и то же
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Как в src/MavlinkMsgTable.cpp: таблицы диалекта ardupilotmega, а не только common
+#include "../Mavlink_Lib/ardupilotmega/mavlink.h"
+
+#include "MavlinkMsgTable.h"
+
+static const mavlink_msg_entry_t crcs[] = MAVLINK_MESSAGE_CRCS;
+static const struct
+{
+    const char* name;
+    uint32_t msgid;
+} msgNames[] = MAVLINK_MESSAGE_NAMES;
+
+static const size_t messageCount = sizeof(crcs) / sizeof(crcs[0]);
+
+// Прежняя реализация mavlink_get_msg_entry из mavlink_helpers.h
+__attribute__((noinline)) static const mavlink_msg_entry_t* bisect(uint32_t msgid)
+{
+    uint32_t low = 0, high = messageCount - 1;
+    while (low < high)
+    {
+        uint32_t mid = (low + 1 + high) / 2;
+        if (msgid < crcs[mid].msgid)
+        {
+            high = mid - 1;
+            continue;
+        }
+        if (msgid > crcs[mid].msgid)
+        {
+            low = mid;
+            continue;
+        }
+        low = mid;
+        break;
+    }
+    return crcs[low].msgid == msgid ? &crcs[low] : nullptr;
+}
+
+// Прежняя реализация mavlink_get_message_info_by_name
+__attribute__((noinline)) static const mavlink_msg_entry_t* byNameBisect(const char* name)
+{
+    const size_t count = sizeof(msgNames) / sizeof(msgNames[0]);
+    uint32_t low = 0, high = count - 1;
+    while (low < high)
+    {
+        uint32_t mid = (low + high) / 2;
+        int cmp = strcmp(msgNames[mid].name, name);
+        if (cmp > 0)
+        {
+            high = mid;
+            continue;
+        }
+        if (cmp < 0)
+        {
+            low = mid + 1;
+            continue;
+        }
+        low = mid;
+        break;
+    }
+    return strcmp(msgNames[low].name, name) == 0 ? bisect(msgNames[low].msgid) : nullptr;
+}
+
+int main()
+{
+    // Все id из 17 бит (с запасом за последним сообщением диалекта) и все имена
+    size_t bad = 0;
+    for (uint32_t id = 0; id < (1u << 17); ++id)
+    {
+        const mavlink_msg_entry_t* a = bisect(id);
+        const mavlink_msg_entry_t* b = mavlink_get_msg_entry(id);
+        bad += (a == nullptr) != (b == nullptr) || (a && memcmp(a, b, sizeof(*a)) != 0);
+
+        const char* name = mavlinkMsgName(id);
+        bad += (a == nullptr) != (name == nullptr) || (name && mavlinkMsgEntryByName(name)->msgid != id);
+    }
+    bad += mavlinkMsgEntryByName("NO_SUCH_MESSAGE") != nullptr || mavlinkMsgEntryByName("") != nullptr;
+    printf("%zu messages, ids 0..131071 and all names checked: %zu mismatches%s\n", messageCount, bad,
+           bad ? "  MISMATCH" : "");
+
+    // Скорость: типичный поток автопилота и случайные известные id
+    std::mt19937 rng(48);
+    const uint32_t traffic[] = {0, 1, 24, 30, 33, 42, 44, 47, 51, 73, 74, 110, 147, 148, 241, 242, 253, 11030, 12920};
+    std::vector<uint32_t> trafficIds(1 << 16), knownIds(1 << 16);
+    for (uint32_t& id : trafficIds) id = traffic[rng() % (sizeof(traffic) / sizeof(traffic[0]))];
+    for (uint32_t& id : knownIds) id = crcs[rng() % messageCount].msgid;
+    std::vector<const char*> names(1 << 16);
+    for (const char*& name : names) name = msgNames[rng() % messageCount].name;
+
+    auto run = [](const char* what, const auto& keys, auto lookup) {
+        const int repeats = 200;
+        uintptr_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+            for (auto key : keys) sink += reinterpret_cast<uintptr_t>(lookup(key));
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("  %-34s %6.2f ns/lookup  (%d)\n", what, seconds * 1e9 / (repeats * keys.size()), int(sink & 1));
+    };
+
+    run("bisection, autopilot traffic", trafficIds, bisect);
+    run("page table, autopilot traffic", trafficIds, mavlink_get_msg_entry);
+    run("bisection, random known ids", knownIds, bisect);
+    run("page table, random known ids", knownIds, mavlink_get_msg_entry);
+    run("name bisection (strcmp)", names, byNameBisect);
+    run("name hash", names, mavlinkMsgEntryByName);
+
+    return 0;
+}
@@ -0,0 +1,175 @@
+// Разбор MAVLink: mavlink_parse_char по байту против mavlink_parse_buffer по датаграмме.
+// Сначала проверка, что оба дают одни и те же сообщения на потоке, разрезанном в случайных
+// местах, затем скорость на потоке по кадру в датаграмме
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "mavlink.h"
+
+static std::mt19937 rng(46);
+
+// Состояние разбора одного потока
+struct ParseState
+{
+    mavlink_status_t status{};
+    mavlink_message_t buffer{};
+};
+
+// Смесь сообщений автопилота, каждое пятое - MAVLink 1; bounds - концы кадров
+static void makeStream(std::vector<uint8_t>& stream, std::vector<size_t>& bounds, int count, bool noise)
+{
+    mavlink_status_t* tx = mavlink_get_channel_status(MAVLINK_COMM_0);
+
+    for (int i = 0; i < count; ++i)
+    {
+        mavlink_message_t msg;
+        int kind = rng() % 4;
+        if (kind == 0)
+            mavlink_msg_heartbeat_pack(1, 1, &msg, 1, 3, 0, rng(), 4);
+        else if (kind == 1)
+            mavlink_msg_mission_item_int_pack(1, 1, &msg, 255, 191, rng() % 500, 6, 16, 0, 1, 0, 0, 0, 0, rng(), rng(),
+                                              50.f, 0);
+        else if (kind == 2)
+        {
+            uint8_t payload[251];
+            for (uint8_t& b : payload) b = rng();
+            mavlink_msg_file_transfer_protocol_pack(1, 1, &msg, 0, 255, 191, payload);
+        }
+        else
+            mavlink_msg_attitude_pack(1, 1, &msg, rng(), 0.1f, 0.2f, 0.3f, 0, 0, 0);
+
+        if (rng() % 5 == 0) tx->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+        uint16_t len = mavlink_msg_to_send_buffer(frame, &msg);
+        tx->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+
+        if (noise && rng() % 7 == 0) frame[rng() % len] ^= 0x5a;
+        if (noise && rng() % 7 == 0)
+            for (int j = 0; j < 5; ++j) stream.push_back(rng() % 3 ? MAVLINK_STX : rng());
+
+        stream.insert(stream.end(), frame, frame + len);
+        bounds.push_back(stream.size());
+    }
+}
+
+// Полезная нагрузка сравнивается только в пределах len: за ней у побайтного разбора старые байты
+static bool sameMessage(const mavlink_message_t& a, const mavlink_message_t& b)
+{
+    return a.msgid == b.msgid && a.len == b.len && a.seq == b.seq && a.sysid == b.sysid && a.compid == b.compid &&
+           a.magic == b.magic && a.checksum == b.checksum && memcmp(_MAV_PAYLOAD(&a), _MAV_PAYLOAD(&b), a.len) == 0;
+}
+
+// Чистый поток должен разбираться одинаково. На шумном (битые байты, ложные STX) разбор
+// расходится: кадр с испорченной длиной не отличить от разрезанного между чтениями, и оба
+// разбора теряют следующие за ним кадры, но разные. Для него счётчики только печатаются
+static void checkSplitStream(bool noise)
+{
+    std::vector<uint8_t> stream;
+    std::vector<size_t> bounds;
+    makeStream(stream, bounds, 20000, noise);
+
+    ParseState bytewise, buffered;
+    std::vector<mavlink_message_t> reference, parsed;
+    mavlink_message_t msg;
+
+    for (uint8_t c : stream)
+        if (mavlink_parse_char_buffer(&bytewise.buffer, &bytewise.status, c, &msg, nullptr))
+            reference.push_back(msg);
+
+    for (size_t pos = 0; pos < stream.size();)
+    {
+        size_t cut = std::min(stream.size(), pos + 1 + rng() % 600);
+        const uint8_t* p = stream.data() + pos;
+        mavlink_frame_view_t frame;
+        while (mavlink_parse_buffer_state(&buffered.buffer, &buffered.status, &p, stream.data() + cut, &frame))
+        {
+            mavlink_frame_view_to_message(&frame, &msg);
+            parsed.push_back(msg);
+        }
+        pos = cut;
+    }
+
+    // Сообщения побайтного разбора ищутся в том же порядке
+    size_t found = 0;
+    for (size_t i = 0, j = 0; i < reference.size(); ++i)
+    {
+        size_t k = j;
+        while (k < parsed.size() && !sameMessage(reference[i], parsed[k])) ++k;
+        if (k < parsed.size())
+        {
+            ++found;
+            j = k + 1;
+        }
+    }
+
+    printf("%s stream cut at random: parse_char %zu messages, parse_buffer %zu, found in order %zu/%zu%s\n",
+           noise ? "noisy" : "clean", reference.size(), parsed.size(), found, reference.size(),
+           noise || found == reference.size() ? "" : "  MISMATCH");
+}
+
+int main()
+{
+    checkSplitStream(false);
+    checkSplitStream(true);
+
+    // Скорость: по одному кадру в датаграмме, как шлёт автопилот
+    std::vector<uint8_t> stream;
+    std::vector<size_t> bounds;
+    makeStream(stream, bounds, 100000, false);
+
+    const int repeats = 20;
+    double megabytes = stream.size() * repeats / 1e6;
+    mavlink_message_t msg;
+
+    auto run = [&](const char* name, auto parseDatagram) {
+        ParseState state;
+        size_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+        {
+            size_t begin = 0;
+            for (size_t end : bounds)
+            {
+                checksum += parseDatagram(state, stream.data() + begin, stream.data() + end);
+                begin = end;
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("  %-34s %7.0f MB/s  %6.1f ns/frame  (msgid sum %zu)\n", name, megabytes / seconds,
+               seconds * 1e9 / (bounds.size() * repeats), checksum);
+    };
+
+    printf("%zu frames, %.1f MB per pass, %d passes\n", bounds.size(), stream.size() / 1e6, repeats);
+
+    run("mavlink_parse_char", [&](ParseState& state, const uint8_t* p, const uint8_t* end) {
+        size_t sum = 0;
+        for (; p < end; ++p)
+            if (mavlink_parse_char_buffer(&state.buffer, &state.status, *p, &msg, nullptr)) sum += msg.msgid;
+        return sum;
+    });
+
+    run("mavlink_parse_buffer, views", [&](ParseState& state, const uint8_t* p, const uint8_t* end) {
+        size_t sum = 0;
+        mavlink_frame_view_t frame;
+        while (mavlink_parse_buffer_state(&state.buffer, &state.status, &p, end, &frame)) sum += frame.msgid;
+        return sum;
+    });
+
+    run("mavlink_parse_buffer + copy", [&](ParseState& state, const uint8_t* p, const uint8_t* end) {
+        size_t sum = 0;
+        mavlink_frame_view_t frame;
+        while (mavlink_parse_buffer_state(&state.buffer, &state.status, &p, end, &frame))
+        {
+            mavlink_frame_view_to_message(&frame, &msg);
+            sum += msg.msgid;
+        }
+        return sum;
+    });
+
+    return 0;
+}
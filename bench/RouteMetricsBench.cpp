@@ -0,0 +1,82 @@
+// Характеристики маршрута: векторные ядра computeRouteMetrics против скалярного
+// computeRouteMetricsScalar - время и расхождение с допусками из RouteMetrics.h
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "RouteMetrics.h"
+
+int main()
+{
+    // Съёмочные галсы с шагом ~10 м и скачок в случайную точку Земли каждые 1000 точек;
+    // участок через антимеридиан (10 -> 11) и совпадающие точки (20 -> 21)
+    std::mt19937 rng(38);
+    std::uniform_real_distribution<double> unit(-1, 1);
+    const int count = 200001;
+    std::vector<WGS84CoordInt> points(count);
+    double lat = 55.7, lon = 37.6;
+    for (int i = 0; i < count; ++i)
+    {
+        if (i % 1000 == 0)
+        {
+            lat = unit(rng) * 89.9;
+            lon = unit(rng) * 180;
+        }
+        else
+        {
+            lat += unit(rng) * 1e-4;
+            lon += unit(rng) * 1e-4;
+        }
+        points[i] = WGS84CoordInt::fromCoord(WGS84Coord(lat, lon, 100 + unit(rng) * 50));
+    }
+    points[10] = {0, 1799999999, 0};
+    points[11] = {0, -1799999999, 0};
+    points[20] = points[21];
+
+    RouteSoA route;
+    route.assign(points.data(), count);
+    RouteMetrics scalar, vector;
+
+    // Лучшее из нескольких прогонов
+    const int repeats = 5;
+    double scalarMs = 1e9, vectorMs = 1e9;
+    for (int r = 0; r < repeats; ++r)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        computeRouteMetricsScalar(route, 15, scalar);
+        auto t1 = std::chrono::steady_clock::now();
+        computeRouteMetrics(route, 15, vector);
+        auto t2 = std::chrono::steady_clock::now();
+        scalarMs = std::min(scalarMs, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        vectorMs = std::min(vectorMs, std::chrono::duration<double, std::milli>(t2 - t1).count());
+    }
+
+    double lengthError = 0, relativeError = 0, bearingError = 0;
+    for (int i = 0; i < count - 1; ++i)
+    {
+        double diff = std::fabs(scalar.legLength[i] - vector.legLength[i]);
+        lengthError = std::max(lengthError, diff);
+        if (scalar.legLength[i] > 1) relativeError = std::max(relativeError, diff / scalar.legLength[i]);
+
+        double angle = std::fabs(scalar.bearing[i] - vector.bearing[i]);
+        angle = std::min(angle, 360 - angle);
+        if (scalar.legLength[i] > 1e-3) bearingError = std::max(bearingError, angle);
+    }
+
+    const bool ok = lengthError <= ROUTE_METRICS_LENGTH_TOLERANCE &&
+                    relativeError <= ROUTE_METRICS_RELATIVE_TOLERANCE &&
+                    bearingError <= ROUTE_METRICS_BEARING_TOLERANCE;
+
+    printf("%d points: scalar %.2f ms, vector %.2f ms, %.1fx\n", count, scalarMs, vectorMs, scalarMs / vectorMs);
+    printf("leg length error %.2e m (tolerance %.0e), relative %.2e (%.0e), bearing %.2e deg (%.0e)%s\n",
+           lengthError, ROUTE_METRICS_LENGTH_TOLERANCE, relativeError, ROUTE_METRICS_RELATIVE_TOLERANCE, bearingError,
+           ROUTE_METRICS_BEARING_TOLERANCE, ok ? "" : "  EXCEEDED");
+    printf("antimeridian leg %.3f m (expected ~0.022), coincident leg %.3f m, total %.1f km, time %.0f s\n",
+           vector.legLength[10], vector.legLength[20], vector.totalDistance / 1000, vector.flightTime);
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+#ifndef CHACHA20_KERNEL_H
+#define CHACHA20_KERNEL_H
+
+#include <cstdint>
+#include <cstring>
+
+// Векторное ядро ChaCha20: N блоков обрабатываются параллельно, в каждой полосе
+// вектора V свой блок (счётчик input[12] + номер полосы). Один и тот же исходник
+// компилируется в SSE2 (x86-64), NEON (AArch64) или AVX2 (u32x8 в файле с -mavx2).
+
+#define CHACHA20_QR(a, b, c, d)                     \
+    a += b; d ^= a; d = (d << 16) | (d >> 16);      \
+    c += d; b ^= c; b = (b << 12) | (b >> 20);      \
+    a += b; d ^= a; d = (d << 8) | (d >> 24);       \
+    c += d; b ^= c; b = (b << 7) | (b >> 25);
+
+// XOR N * 64 байт data с ключевым потоком, начиная с блока input[12]
+template <typename V>
+inline void chacha20XorBlocksV(const uint32_t input[16], uint8_t* data)
+{
+    constexpr int N = sizeof(V) / sizeof(uint32_t);
+
+    V x[16], orig[16];
+    for (int i = 0; i < 16; ++i)
+        x[i] = V{} + input[i];
+    for (int lane = 0; lane < N; ++lane)
+        x[12][lane] += lane;
+    for (int i = 0; i < 16; ++i)
+        orig[i] = x[i];
+
+    for (int round = 0; round < 10; ++round)
+    {
+        CHACHA20_QR(x[0], x[4], x[8],  x[12]);
+        CHACHA20_QR(x[1], x[5], x[9],  x[13]);
+        CHACHA20_QR(x[2], x[6], x[10], x[14]);
+        CHACHA20_QR(x[3], x[7], x[11], x[15]);
+        CHACHA20_QR(x[0], x[5], x[10], x[15]);
+        CHACHA20_QR(x[1], x[6], x[11], x[12]);
+        CHACHA20_QR(x[2], x[7], x[8],  x[13]);
+        CHACHA20_QR(x[3], x[4], x[9],  x[14]);
+    }
+
+    for (int i = 0; i < 16; ++i)
+        x[i] += orig[i];
+
+    for (int lane = 0; lane < N; ++lane)
+    {
+        uint8_t* block = data + lane * 64;
+        for (int i = 0; i < 16; ++i)
+        {
+            uint32_t word = x[i][lane];
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            uint32_t value;
+            memcpy(&value, block + 4 * i, sizeof(value));
+            value ^= word;
+            memcpy(block + 4 * i, &value, sizeof(value));
+#else
+            block[4 * i + 0] ^= static_cast<uint8_t>(word);
+            block[4 * i + 1] ^= static_cast<uint8_t>(word >> 8);
+            block[4 * i + 2] ^= static_cast<uint8_t>(word >> 16);
+            block[4 * i + 3] ^= static_cast<uint8_t>(word >> 24);
+#endif
+        }
+    }
+}
+
+#undef CHACHA20_QR
+
+#ifdef HAVE_AVX2_KERNELS
+// 8 блоков за вызов, src/ChaCha20_avx2.cpp
+void chacha20XorBlocks8(const uint32_t input[16], uint8_t* data);
+#endif
+
+#endif // CHACHA20_KERNEL_H
@@ -0,0 +1,68 @@
+#ifndef CHACHA20_POLY1305_H
+#define CHACHA20_POLY1305_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define CHACHA20_KEY_SIZE    32
+#define CHACHA20_NONCE_SIZE  12
+#define POLY1305_TAG_SIZE    16
+
+// Потоковый ChaCha20 (RFC 8439). process можно вызывать частями любой длины
+class ChaCha20
+{
+private:
+    uint32_t state[16];
+    uint8_t keystream[256];
+    size_t used = sizeof(keystream);
+
+    void xorBlocks(uint8_t* data, size_t blocks);
+
+public:
+    void init(const uint8_t key[CHACHA20_KEY_SIZE], const uint8_t nonce[CHACHA20_NONCE_SIZE], uint32_t counter);
+    void process(uint8_t* data, size_t size);
+};
+
+// Poly1305, 26-битные limb'ы (как poly1305-donna-32)
+class Poly1305
+{
+private:
+    uint32_t r[5], h[5], pad[4];
+    uint8_t buffer[16];
+    size_t buffered = 0;
+
+    void blocks(const uint8_t* data, size_t size, uint32_t hibit);
+
+public:
+    void init(const uint8_t key[32]);
+    void update(const uint8_t* data, size_t size);
+    void finish(uint8_t tag[POLY1305_TAG_SIZE]);
+};
+
+// AEAD ChaCha20-Poly1305 (RFC 8439), шифрование и проверка на месте, по частям
+class ChaCha20Poly1305
+{
+private:
+    ChaCha20 cipher;
+    Poly1305 mac;
+    uint64_t aadSize = 0;
+    uint64_t textSize = 0;
+    bool aadPadded = false;
+
+    void padMac(uint64_t size);
+    void finishAad();
+
+public:
+    void init(const uint8_t key[CHACHA20_KEY_SIZE], const uint8_t nonce[CHACHA20_NONCE_SIZE]);
+    // Дополнительные аутентифицируемые данные, до первого encrypt/decrypt
+    void aad(const uint8_t* data, size_t size);
+    void encrypt(uint8_t* data, size_t size);
+    void decrypt(uint8_t* data, size_t size);
+    // Только аутентификация шифртекста, без расшифровки
+    void authenticate(const uint8_t* data, size_t size);
+    void finish(uint8_t tag[POLY1305_TAG_SIZE]);
+    // Сравнение за постоянное время
+    bool verify(const uint8_t tag[POLY1305_TAG_SIZE]);
+};
+
+#endif // CHACHA20_POLY1305_H
@@ -17,4 +17,43 @@
 
 #define CAMERA_FAIL_CODE 255
 
+// Ключ ChaCha20-Poly1305 для маршрутов и кадров (32 байта или 64 hex-символа)
+#define PAYLOAD_KEY_FILE		"payload.key"
+
+// Без файла ключа маршруты и кадры не принимаются (NoKeyProtector). 1 - прежний XOR
+// без контроля целостности, только для стенда со старой стороной ПК
+#define PAYLOAD_ALLOW_XOR_FALLBACK	0
+
+// Верхняя граница числа точек в принятом маршруте, ограничивает резервирование памяти
+#define ROUTE_MAX_POINTS		1000000
+
+// Допуск прореживания маршрута перед выгрузкой, метры (0 - выключено)
+#define ROUTE_SIMPLIFY_TOLERANCE_M	1.0
+
+// Файл маршрута на стороне ПК (см. RouteStore.h)
+#define ROUTE_STORE_FILE		"route.bin"
+
+// Крейсерская скорость для оценки времени полёта по маршруту, м/с
+#define ROUTE_CRUISE_SPEED_MS		15.0
+
+// Запретные зоны (см. Geofence::loadFile): без файла маршрут не проверяется,
+// при испорченном файле все маршруты отклоняются
+#define GEOFENCE_FILE			"geofence.txt"
+
+// Приёмный буфер MAVLink: в одной UDP-датаграмме может прийти несколько кадров
+#define MAVLINK_DATAGRAM_MAX		 2048
+
+#define HEARTBEAT_TIMEOUT_MS		 5000
+#define MISSION_UPLOAD_TIMEOUT_MS	30000
+
+// Повтор MISSION_COUNT или пункта миссии, если автопилот молчит (см. MissionUploader.h)
+#define MISSION_ITEM_TIMEOUT_MS		 1500
+#define MISSION_MAX_RETRIES		    5
+
+// Сколько пунктов запрашивается одновременно при чтении миссии с автопилота
+#define MISSION_READBACK_WINDOW		    8
+
+// С какого числа точек миссия загружается файлом по MAVLink FTP, если автопилот его поддерживает
+#define MISSION_FTP_MIN_POINTS		   50
+
 #endif
\ No newline at end of file
@@ -2,36 +2,116 @@
 #define FLYPLANEDATA_H
 
 #include <cstddef> // для size_t
+#include <cstdint>
+#include <vector>
+
+#include "WireSchema.h"
 
 class WGS84Coord
 {
 public:
-    float lat, lon, alt;
+    double lat, lon, alt;
     
     WGS84Coord();
-    WGS84Coord(float lat, float lon, float alt);
+    WGS84Coord(double lat, double lon, double alt);
+};
+
+// Координата в целочисленном виде, как в MISSION_ITEM_INT:
+// широта и долгота в 1e-7 градуса, высота в миллиметрах
+struct WGS84CoordInt
+{
+    int32_t lat = 0;
+    int32_t lon = 0;
+    int32_t alt = 0;
+
+    static WGS84CoordInt fromCoord(const WGS84Coord& coord);
+    WGS84Coord toCoord() const;
+
+    bool operator==(const WGS84CoordInt& other) const;
+    bool operator!=(const WGS84CoordInt& other) const;
+};
+
+// Формат маршрута на проводе (все поля little-endian):
+//   magic u32 | version u8 | flags u8 | headerSize u16 | pointCount u32 | payloadSize u32 | crc32 u32
+//   затем pointCount записей: lat i32 | lon i32 | alt i32 (или сжатые, см. RouteCodec.h)
+// crc32 считается по полезной нагрузке. Устаревший формат (int + float[3] без заголовка)
+// по-прежнему принимается при десериализации.
+#define ROUTE_MAGIC         0x52564155u // "UAVR"
+#define ROUTE_VERSION       1
+#define ROUTE_HEADER_SIZE   20
+#define ROUTE_POINT_SIZE    12
+
+struct RouteHeader
+{
+    uint32_t magic = ROUTE_MAGIC;
+    uint8_t version = ROUTE_VERSION;
+    uint8_t flags = 0;
+    uint16_t headerSize = ROUTE_HEADER_SIZE;
+    uint32_t pointCount = 0;
+    uint32_t payloadSize = 0;
+    uint32_t crc = 0;
+};
+
+template <>
+struct WireDescription<RouteHeader>
+    : WireSchema<WireField<&RouteHeader::magic>, WireField<&RouteHeader::version>,
+                 WireField<&RouteHeader::flags>, WireField<&RouteHeader::headerSize>,
+                 WireField<&RouteHeader::pointCount>, WireField<&RouteHeader::payloadSize>,
+                 WireField<&RouteHeader::crc>>
+{
+    static constexpr const char* name = "RouteHeader";
+};
+
+template <>
+struct WireDescription<WGS84CoordInt>
+    : WireSchema<WireField<&WGS84CoordInt::lat>, WireField<&WGS84CoordInt::lon>, WireField<&WGS84CoordInt::alt>>
+{
+    static constexpr const char* name = "RoutePoint";
 };
 
+static_assert(wireSize<RouteHeader>() == ROUTE_HEADER_SIZE, "RouteHeader layout");
+static_assert(wireSize<WGS84CoordInt>() == ROUTE_POINT_SIZE, "RoutePoint layout");
+
+void encodeRouteHeader(const RouteHeader& header, unsigned char* data);
+bool decodeRouteHeader(const unsigned char* data, size_t size, RouteHeader& header);
+
+void encodeRoutePoint(const WGS84CoordInt& point, unsigned char* data);
+WGS84CoordInt decodeRoutePoint(const unsigned char* data);
+
+// Маршрут владеет точками единолично: копирование запрещено, передача - только перемещением
 class FlyPlaneData
 {
 private:
-    int pointCount;
-    WGS84Coord* coords;
-    const char* key = "uav";
-
-    void xorEncryptDecrypt(unsigned char* data, size_t size);
+    std::vector<WGS84CoordInt> points;
+    uint8_t encodingFlags = 0;
 
 public:
-    FlyPlaneData();
-    ~FlyPlaneData();
+    FlyPlaneData() = default;
+    FlyPlaneData(const FlyPlaneData&) = delete;
+    FlyPlaneData& operator=(const FlyPlaneData&) = delete;
+    FlyPlaneData(FlyPlaneData&&) noexcept = default;
+    FlyPlaneData& operator=(FlyPlaneData&&) noexcept = default;
     
     void setCoords(WGS84Coord* newCoords, int count);
-    WGS84Coord* getCoords() const;
+    void setPoints(const WGS84CoordInt* newPoints, int count);
+    // Забирает готовый массив без копирования
+    void setPoints(std::vector<WGS84CoordInt>&& newPoints);
+    const WGS84CoordInt* getPoints() const;
     int getPointCount() const;
 
+    // Наращивание маршрута по мере приёма (см. RouteStreamDecoder)
+    void reserve(size_t count);
+    void append(const WGS84CoordInt& point);
+    void clear();
+
+    // Кодировка точек при сериализации (ROUTE_FLAG_*), получатель узнаёт её из заголовка
+    void setEncodingFlags(uint8_t flags);
+    uint8_t getEncodingFlags() const;
+
+    // Сообщение защищается текущим payloadProtector(), его размер - getSerializedSize()
     unsigned char* Serialization();
     bool DeSerialization(unsigned char* data, size_t data_size);
     size_t getSerializedSize() const;
 };
 
-#endif // FLYPLANEDATA_H
\ No newline at end of file
+#endif // FLYPLANEDATA_H
@@ -0,0 +1,71 @@
+#ifndef FLYPLANEDATA_VIEW_H
+#define FLYPLANEDATA_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "FlyPlaneData.h"
+#include "RouteCodec.h"
+
+// Невладеющее представление незашифрованного маршрута поверх буфера (например, файла
+// RouteStore). Ничего не копирует: точки декодируются по мере обращения.
+// Буфер должен жить дольше view.
+class FlyPlaneDataView
+{
+private:
+    const unsigned char* payload = nullptr;
+    size_t payloadSize = 0;
+    uint32_t pointCount = 0;
+    uint8_t encodingFlags = 0;
+    bool legacy = false;
+
+    // Курсор для сжатого формата: последовательные запросы at() не читают маршрут заново
+    mutable RoutePointReader cursor{nullptr, 0, 0, 0};
+    mutable WGS84CoordInt cursorPoint;
+
+public:
+    class Iterator
+    {
+    private:
+        const FlyPlaneDataView* view;
+        uint32_t index;
+        RoutePointReader reader;
+        WGS84CoordInt point;
+
+        void load();
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = WGS84CoordInt;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const WGS84CoordInt*;
+        using reference = const WGS84CoordInt&;
+
+        Iterator(const FlyPlaneDataView* view, uint32_t index);
+
+        reference operator*() const { return point; }
+        pointer operator->() const { return &point; }
+        Iterator& operator++();
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+    };
+
+    // Разбор незашифрованного маршрута (например, отображённого в память файла RouteStore)
+    bool parsePlain(const unsigned char* data, size_t size);
+
+    uint32_t getPointCount() const;
+    uint8_t getEncodingFlags() const;
+    bool isLegacy() const;
+
+    // O(1) для несжатого формата, для сжатого - чтение вперёд от последнего запроса
+    bool at(uint32_t index, WGS84CoordInt& point) const;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    // Копия точек во владеющий контейнер
+    void copyTo(FlyPlaneData& data) const;
+};
+
+#endif // FLYPLANEDATA_VIEW_H
@@ -0,0 +1,188 @@
+#ifndef GEODESY_KERNEL_H
+#define GEODESY_KERNEL_H
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Векторные ядра гаверсинуса: N участков маршрута за раз, по одному в каждой полосе
+// вектора V. Тригонометрия полиномиальная, без вызовов libm. Один исходник даёт
+// SSE2 (x86-64), NEON (AArch64) или AVX2 (f64x4 в файле с -mavx2).
+//
+// Точность относительно std::sin/std::atan2 - порядка 1e-15 (ряды до x^19/x^20 на
+// [-pi/2, pi/2], atan по Cephes), на расстояниях это доли микрометра.
+
+#define GEODESY_EARTH_RADIUS_M 6371008.8
+
+typedef double f64x2 __attribute__((vector_size(16)));
+
+template <typename V>
+inline V geoSplat(double x)
+{
+    return V{} + x;
+}
+
+template <typename V>
+inline V geoLoad(const double* data)
+{
+    V v;
+    memcpy(&v, data, sizeof(v));
+    return v;
+}
+
+template <typename V>
+inline void geoStore(double* data, V v)
+{
+    memcpy(data, &v, sizeof(v));
+}
+
+template <typename V>
+inline V geoSqrt(V x)
+{
+    for (size_t i = 0; i < sizeof(V) / sizeof(double); ++i)
+        x[i] = __builtin_sqrt(x[i]);
+    return x;
+}
+
+template <>
+inline f64x2 geoSqrt<f64x2>(f64x2 x)
+{
+#if defined(__SSE2__)
+    return _mm_sqrt_pd(x);
+#elif defined(__aarch64__)
+    return (f64x2)vsqrtq_f64((float64x2_t)x);
+#else
+    return f64x2{__builtin_sqrt(x[0]), __builtin_sqrt(x[1])};
+#endif
+}
+
+// sin на [-pi/2, pi/2], ряд Тейлора до x^19
+template <typename V>
+inline V geoSin(V x)
+{
+    V x2 = x * x;
+    V p = geoSplat<V>(-1.0 / 121645100408832000.0);
+    p = p * x2 + 1.0 / 355687428096000.0;
+    p = p * x2 - 1.0 / 1307674368000.0;
+    p = p * x2 + 1.0 / 6227020800.0;
+    p = p * x2 - 1.0 / 39916800.0;
+    p = p * x2 + 1.0 / 362880.0;
+    p = p * x2 - 1.0 / 5040.0;
+    p = p * x2 + 1.0 / 120.0;
+    p = p * x2 - 1.0 / 6.0;
+    return (p * x2 + 1.0) * x;
+}
+
+// cos на [-pi/2, pi/2], ряд Тейлора до x^20
+template <typename V>
+inline V geoCos(V x)
+{
+    V x2 = x * x;
+    V p = geoSplat<V>(1.0 / 2432902008176640000.0);
+    p = p * x2 - 1.0 / 6402373705728000.0;
+    p = p * x2 + 1.0 / 20922789888000.0;
+    p = p * x2 - 1.0 / 87178291200.0;
+    p = p * x2 + 1.0 / 479001600.0;
+    p = p * x2 - 1.0 / 3628800.0;
+    p = p * x2 + 1.0 / 40320.0;
+    p = p * x2 - 1.0 / 720.0;
+    p = p * x2 + 1.0 / 24.0;
+    p = p * x2 - 1.0 / 2.0;
+    return p * x2 + 1.0;
+}
+
+// atan на [0, 1]: при t > 0.66 atan(t) = pi/4 + atan((t - 1) / (t + 1)), далее
+// рациональное приближение Cephes
+template <typename V>
+inline V geoAtanUnit(V t)
+{
+    V one = geoSplat<V>(1.0);
+    auto reduce = t > 0.66;
+    V x = reduce ? (t - one) / (t + one) : t;
+    V base = reduce ? geoSplat<V>(0.78539816339744830962 + 0.5 * 6.123233995736765886130e-17) : V{};
+
+    V z = x * x;
+    V p = geoSplat<V>(-8.750608600031904122785e-1);
+    p = p * z - 1.615753718733365076637e1;
+    p = p * z - 7.500855792314704667340e1;
+    p = p * z - 1.228866684490136173410e2;
+    p = p * z - 6.485021904942025371773e1;
+    V q = z + 2.485846490142306297962e1;
+    q = q * z + 1.650270098316988542046e2;
+    q = q * z + 4.328810604912902668951e2;
+    q = q * z + 4.853903996359136964868e2;
+    q = q * z + 1.945506571482613964425e2;
+
+    return base + (x * (z * p / q) + x);
+}
+
+template <typename V>
+inline V geoAtan2(V y, V x)
+{
+    V zero = V{};
+    V ay = y < zero ? -y : y;
+    V ax = x < zero ? -x : x;
+
+    // Отношение всегда в [0, 1], совпавшие точки (0, 0) дают 0
+    auto swap = ay > ax;
+    V num = swap ? ax : ay;
+    V den = swap ? ay : ax;
+    V r = den > zero ? geoAtanUnit(num / (den > zero ? den : geoSplat<V>(1.0))) : zero;
+
+    r = swap ? geoSplat<V>(1.57079632679489661923) - r : r;
+    r = x < zero ? geoSplat<V>(3.14159265358979323846) - r : r;
+    return y < zero ? -r : r;
+}
+
+// sin и cos широт (радианы) N точек
+template <typename V>
+inline void geodesyPointsV(const double* lat, double* sinLat, double* cosLat)
+{
+    V phi = geoLoad<V>(lat);
+    geoStore(sinLat, geoSin(phi));
+    geoStore(cosLat, geoCos(phi));
+}
+
+// N участков i -> i + 1: длина по гаверсинусу (м) и начальный азимут (градусы, 0..360)
+template <typename V>
+inline void geodesyLegsV(const double* lat, const double* lon, const double* sinLat, const double* cosLat,
+                         double* distance, double* bearing)
+{
+    const double pi = 3.14159265358979323846;
+
+    V dLon = geoLoad<V>(lon + 1) - geoLoad<V>(lon);
+    dLon = dLon > pi ? dLon - 2 * pi : dLon;
+    dLon = dLon < -pi ? dLon + 2 * pi : dLon;
+
+    V s1 = geoLoad<V>(sinLat), s2 = geoLoad<V>(sinLat + 1);
+    V c1 = geoLoad<V>(cosLat), c2 = geoLoad<V>(cosLat + 1);
+
+    V sHalfLat = geoSin(0.5 * (geoLoad<V>(lat + 1) - geoLoad<V>(lat)));
+    V sHalfLon = geoSin(0.5 * dLon);
+    V cHalfLon = geoCos(0.5 * dLon);
+
+    V a = sHalfLat * sHalfLat + c1 * c2 * sHalfLon * sHalfLon;
+    a = a > 1.0 ? geoSplat<V>(1.0) : a;
+    V central = 2.0 * geoAtan2(geoSqrt(a), geoSqrt(1.0 - a));
+    geoStore(distance, central * GEODESY_EARTH_RADIUS_M);
+
+    // sin(dLon) = 2 sin(dLon/2) cos(dLon/2), cos(dLon) = 1 - 2 sin^2(dLon/2)
+    V y = 2.0 * sHalfLon * cHalfLon * c2;
+    V x = c1 * s2 - s1 * c2 * (1.0 - 2.0 * sHalfLon * sHalfLon);
+    V azimuth = geoAtan2(y, x) * (180.0 / pi);
+    geoStore(bearing, azimuth < 0.0 ? azimuth + 360.0 : azimuth);
+}
+
+#ifdef HAVE_AVX2_KERNELS
+// src/Geodesy_avx2.cpp, по 4 точки/участка
+void geodesyPoints4(const double* lat, double* sinLat, double* cosLat);
+void geodesyLegs4(const double* lat, const double* lon, const double* sinLat, const double* cosLat,
+                  double* distance, double* bearing);
+#endif
+
+#endif // GEODESY_KERNEL_H
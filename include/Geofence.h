@@ -0,0 +1,84 @@
+#ifndef GEOFENCE_H
+#define GEOFENCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FlyPlaneData.h"
+
+// Участок маршрута (точки leg -> leg + 1), задевающий запретную зону polygon
+// (номер полигона в порядке добавления)
+struct GeofenceViolation
+{
+    int leg;
+    int polygon;
+};
+
+// polygon в нарушении, когда зоны не удалось загрузить или индекс не построен:
+// проверка не пройдена для любого маршрута (leg = -1)
+const int GEOFENCE_INVALID = -1;
+
+// Запретные зоны в R-дереве, упакованном методом STR (Sort-Tile-Recursive).
+// Геометрия плоская в градусах: зоны не должны пересекать меридиан ±180
+class Geofence
+{
+private:
+    struct Box
+    {
+        double minLat, minLon, maxLat, maxLon;
+
+        bool intersects(const Box& other) const;
+        void expand(const Box& other);
+    };
+
+    // Дочерние узлы (или полигоны для листа) лежат подряд: first .. first + count
+    struct Node
+    {
+        Box box;
+        uint32_t first;
+        uint32_t count;
+        bool leaf;
+    };
+
+    struct Polygon
+    {
+        int id; // порядковый номер при загрузке
+        std::vector<double> lat, lon;
+        Box box;
+    };
+
+    std::vector<Polygon> polygons;
+    std::vector<Node> nodes; // корень - последний
+    bool built = false;
+    bool broken = false;     // файл зон испорчен, загружена только часть
+
+    static bool segmentsIntersect(double aLat, double aLon, double bLat, double bLon,
+                                  double cLat, double cLon, double dLat, double dLon);
+    bool contains(const Polygon& polygon, double lat, double lon) const;
+    bool touches(const Polygon& polygon, double aLat, double aLon, double bLat, double bLon) const;
+
+public:
+    // Дочерних элементов в узле дерева
+    static constexpr int NODE_CAPACITY = 16;
+
+    // Полигон без повторения первой вершины в конце, не меньше 3 вершин
+    bool addPolygon(const std::vector<WGS84Coord>& vertices);
+
+    // Текстовый файл: число вершин, затем пары "lat lon"; полигоны подряд.
+    // Нет файла - false, зон нет. Испорченный файл - false, и check отклоняет любой маршрут
+    bool loadFile(const char* path);
+
+    // Упаковка индекса, вызывается один раз после загрузки всех зон
+    void build();
+
+    size_t size() const;
+
+    // Нарушения маршрута, пустой результат - маршрут допустим.
+    // Маршрут из одной точки проверяется на попадание точки в зону (leg = 0).
+    // Без build() или после испорченного файла - одно нарушение GEOFENCE_INVALID
+    std::vector<GeofenceViolation> check(const WGS84CoordInt* points, int count) const;
+    std::vector<GeofenceViolation> check(const FlyPlaneData& route) const;
+};
+
+#endif // GEOFENCE_H
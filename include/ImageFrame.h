@@ -0,0 +1,24 @@
+#ifndef IMAGE_FRAME_H
+#define IMAGE_FRAME_H
+
+#include <cstdint>
+
+#include "WireSchema.h"
+
+// Заголовок кадра перед защищённым сообщением с изображением
+struct ImageHeader
+{
+    uint32_t size = 0;        // длина защищённого сообщения, байт
+    uint32_t sequence = 0;    // номер кадра, пропуски видны получателю
+    uint64_t timestampMs = 0; // время съёмки, мс от эпохи Unix
+};
+
+template <>
+struct WireDescription<ImageHeader>
+    : WireSchema<WireField<&ImageHeader::size>, WireField<&ImageHeader::sequence>,
+                 WireField<&ImageHeader::timestampMs>>
+{
+    static constexpr const char* name = "ImageHeader";
+};
+
+#endif // IMAGE_FRAME_H
@@ -7,39 +7,96 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
 #include "FlyPlaneData.h"
+#include "RouteStreamDecoder.h"
 
 #define BUFFER_SIZE 2097152
+// Фрагмент чтения при потоковом приёме маршрута
+#define ROUTE_CHUNK_SIZE 65536
+
+// Параметры переподключения клиента
+#define TCP_RECONNECT_MIN_MS	  100
+#define TCP_RECONNECT_MAX_MS	 5000
+#define TCP_CONNECT_TIMEOUT_MS	 2000
+#define TCP_USER_TIMEOUT_MS		 3000
 
 class InterfaceTCPServer
 {
 public:
-    int server_fd, client_fd;
+    int server_fd, client_fd = -1;
     struct sockaddr_in address;
     socklen_t addrlen = sizeof(address);
 
     InterfaceTCPServer(const char* ip, const int port);
     ~InterfaceTCPServer();
 
+    // Копия закрыла бы чужие сокеты в деструкторе
+    InterfaceTCPServer(const InterfaceTCPServer&) = delete;
+    InterfaceTCPServer& operator=(const InterfaceTCPServer&) = delete;
+
     int recvData(uint8_t buffer[]);
+    // Читает ровно size байт; при обрыве закрывает клиента и возвращает -1
+    int recvExact(uint8_t* buffer, size_t size);
     bool ConnectToClient();
+    // Декодирует маршрут по мере приёма фрагментами ROUTE_CHUNK_SIZE, без буфера на всё сообщение
     int readFlyPlaneData(FlyPlaneData &data);
 };
 
+enum class TCPState
+{
+    Disconnected,
+    Connecting,
+    Connected
+};
+
+// Соединением управляет фоновый поток: неблокирующий connect, экспоненциальная
+// задержка со случайным разбросом между попытками, keepalive и TCP_USER_TIMEOUT
+// для быстрого обнаружения пропавшего сервера. Отправка при отсутствии
+// соединения сразу возвращает -1 и не блокирует вызывающий поток; отправка
+// идёт без блокировки состояния соединения, поток управления её не ждёт.
 class InterfaceTCPClient
 {
 private:
     const char* IP;
     int PORT;
+
+    std::atomic<TCPState> state{TCPState::Disconnected};
+    std::atomic<bool> running{true};
+    std::mutex sendMutex;           // sock, sending
+    std::mutex writeMutex;          // сообщения разных потоков не перемешиваются
+    bool sending = false;           // sock занят отправкой, закроет его отправляющий поток
+    std::thread manager;
+    int wakeFd = -1;
+
+    bool ConnectToServer();
+    void configureSocket();
+    void disconnect();
+    bool sleepFor(int ms);
+    void managerLoop();
+
 public:
-    int sock;
+    int sock = -1;
     sockaddr_in serv_addr;
 
     InterfaceTCPClient(const char* ip, const int port);
 	~InterfaceTCPClient();
 
-    int sendData(unsigned char* data, size_t dataSize);
-    bool ConnectToServer();
+    InterfaceTCPClient(const InterfaceTCPClient&) = delete;
+    InterfaceTCPClient& operator=(const InterfaceTCPClient&) = delete;
+
+    TCPState getState() const;
+    bool isConnected() const;
+    bool waitConnected(std::chrono::milliseconds timeout);
+
+    // dropIfFull: предыдущее сообщение ещё не ушло из сокета или буфер полон - сообщение
+    // отбрасывается целиком (возвращает 0), иначе ожидание места до TCP_USER_TIMEOUT_MS.
+    // Начатое сообщение всегда досылается
+    int sendData(unsigned char* data, size_t dataSize, bool dropIfFull = false);
     int sendFlyPlaneData(FlyPlaneData& data);
 };
 
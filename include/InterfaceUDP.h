@@ -5,6 +5,9 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <net/if.h>
+#include <time.h>
+#include <chrono>
 #include <iostream>
 #include <cstring> // для size_t
 
@@ -12,20 +15,89 @@
 
 #define BUFFER_SIZE 2097152
 
+// Максимальное число датаграмм, забираемых одним вызовом recvBatch
+#define UDP_BATCH_MAX 64
+
+// Время приёма пакета ядром (CLOCK_REALTIME). Нулевое значение - метка недоступна.
+struct RecvTimestamp
+{
+	timespec software{};
+	timespec hardware{};
+
+	bool hasSoftware() const { return software.tv_sec != 0 || software.tv_nsec != 0; }
+	bool hasHardware() const { return hardware.tv_sec != 0 || hardware.tv_nsec != 0; }
+};
+
+// Один элемент пакетного приёма: буфер задаёт вызывающий, остальное заполняет recvBatch
+struct UDPDatagram
+{
+	uint8_t* data = nullptr;
+	uint16_t capacity = 0;
+	ssize_t length = 0;
+	sockaddr_storage from{};
+	socklen_t fromLen = 0;
+	RecvTimestamp stamp;
+};
+
+enum class UDPFamily
+{
+	IPv4,
+	IPv6,
+	DualStack   // сокет AF_INET6 без IPV6_V6ONLY, IPv4-адреса как ::ffff:a.b.c.d
+};
+
 class InterfaceUDP
 {
 public:
 	int handler;
-	sockaddr_in sent_addr, recv_addr;
+	sockaddr_storage sent_addr, recv_addr;
+	socklen_t sent_len = 0;
 
-	InterfaceUDP(char* ip, int port); 
+	// Семейство выбирается по адресу: IPv6-литерал - IPv6, иначе IPv4
+	InterfaceUDP(const char* ip, int port, bool reusePort = false); 
+	InterfaceUDP(const char* ip, int port, UDPFamily family, bool reusePort = false);
 	~InterfaceUDP();
 
+	// Если ip - адрес группы, sendTo рассылает всем подписчикам одной отправкой.
+	// Подписчик создаёт сокет на том же порту и вызывает joinGroup
+	bool joinGroup(const char* group, const char* iface = nullptr);
+	bool leaveGroup(const char* group, const char* iface = nullptr);
+	bool setMulticastTTL(int ttl);
+	bool setMulticastInterface(const char* iface);
+	bool setMulticastLoop(bool enable);
+
+	// Включает метки времени приёма: SO_TIMESTAMPING (программные и, если задан
+	// hwInterface и его поддерживает сетевая карта, аппаратные), иначе SO_TIMESTAMPNS
+	bool enableTimestamps(const char* hwInterface = nullptr);
+
 	int sendTo(uint8_t buffer[], uint16_t len);
 	ssize_t recvFrom(uint8_t buffer[], uint16_t len);
+	ssize_t recvFrom(uint8_t buffer[], uint16_t len, RecvTimestamp& stamp, int flags = 0);
+	int recvBatch(UDPDatagram* datagrams, int count, int flags = MSG_WAITFORONE);
+
+	// Ожидание через poll до deadline. При истечении срока возвращает -1 и errno = ETIMEDOUT,
+	// после cancel() - -1 и errno = ECANCELED
+	ssize_t recvUntil(uint8_t buffer[], uint16_t len, std::chrono::steady_clock::time_point deadline);
+	ssize_t recvUntil(uint8_t buffer[], uint16_t len, RecvTimestamp& stamp, std::chrono::steady_clock::time_point deadline);
+	bool waitReadable(std::chrono::steady_clock::time_point deadline);
+
+	// Прерывает текущие и последующие ожидания (можно вызывать из другого потока)
+	void cancel();
+	void resetCancel();
+	bool isCancelled() const;
 
 	void sendFlyPlaneData(FlyPlaneData& data);
 	int readFlyPlaneData(FlyPlaneData& data);
+
+private:
+	int family = AF_INET;
+	bool fixedTarget = false;
+	bool timestamping = false;
+	int cancelFd = -1;
+
+	bool membership(const char* group, const char* iface, int option);
+	bool sendsIPv4() const;
+	void rememberSender(const sockaddr_storage& from, socklen_t len);
 };
 
-#endif
\ No newline at end of file
+#endif
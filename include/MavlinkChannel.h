@@ -0,0 +1,53 @@
+#ifndef MAVLINK_CHANNEL_H
+#define MAVLINK_CHANNEL_H
+
+#include <cstdint>
+
+#include "mavlink.h"
+
+// Состояние одного канала MAVLink (сокет автопилота, последовательный порт): разбор,
+// недособранный кадр, подпись и порядковый номер отправки. Библиотека держит их в
+// статических массивах mavlink_get_channel_status / mavlink_get_channel_buffer, общих
+// для всех потоков; каналы MavlinkChannel ничего не делят и блокировок не требуют.
+// Один объект - один канал и один поток
+class MavlinkChannel
+{
+private:
+    mavlink_status_t status;
+    mavlink_message_t rxBuffer;     // кадр, разрезанный между чтениями
+    mavlink_signing_t signing;
+    mavlink_signing_streams_t streams;
+
+public:
+    MavlinkChannel();
+
+    MavlinkChannel(const MavlinkChannel&) = delete;
+    MavlinkChannel& operator=(const MavlinkChannel&) = delete;
+
+    // Следующее сообщение из [p, end), p сдвигается за него (см. mavlink_parse_buffer).
+    // false - данные кончились, незаконченный кадр продолжит следующий вызов
+    bool parse(const uint8_t*& p, const uint8_t* end, mavlink_frame_view_t& frame);
+
+    // Побайтный разбор, true - msg собрано
+    bool parseChar(uint8_t c, mavlink_message_t& msg);
+
+    // Подпись MAVLink 2 ключом key, linkId - номер канала в подписи. Неподписанные входящие
+    // пакеты отбрасываются, если acceptUnsigned их не разрешит. Отметки времени потоков
+    // подписи у каждого канала свои, поэтому ключ у разных каналов должен быть разный
+    void enableSigning(const uint8_t (&key)[32], uint8_t linkId, bool signOutgoing = true,
+                       mavlink_accept_unsigned_t acceptUnsigned = nullptr);
+    void disableSigning();
+    bool signingEnabled() const;
+
+    // Кадр msg для отправки по этому каналу: порядковый номер канала и его подпись.
+    // out - не меньше MAVLINK_MAX_PACKET_LEN, 0 - сообщение не из диалекта
+    uint16_t encode(const mavlink_message_t& msg, uint8_t* out);
+
+    // Отбрасывает недособранный кадр (например, после переподключения)
+    void reset();
+
+    // Счётчики принятых, потерянных и испорченных пакетов
+    const mavlink_status_t& getStatus() const;
+};
+
+#endif // MAVLINK_CHANNEL_H
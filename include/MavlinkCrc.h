@@ -0,0 +1,27 @@
+#ifndef MAVLINK_CRC_H
+#define MAVLINK_CRC_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mavlink.h"
+
+// Контрольная сумма кадров MAVLink (CRC-16/MCRF4XX, X.25) для целых буферов.
+// С HAVE_CRC_ACCUMULATE_BUFFER библиотека берёт отсюда crc_calculate и
+// crc_accumulate_buffer; результат совпадает с побайтным crc_accumulate
+
+// С какой длины свёртка PCLMULQDQ быстрее таблиц
+#define MAVLINK_CRC_FOLD_MIN	64
+
+// Продолжает crc по size байтам, выбирая реализацию по длине и процессору
+uint16_t crcMcrf4xxUpdate(uint16_t crc, const uint8_t* data, size_t size);
+
+// Таблицы slice-by-8: 8 байт за шаг
+uint16_t crcMcrf4xxSlice8(uint16_t crc, const uint8_t* data, size_t size);
+
+#ifdef HAVE_PCLMUL_KERNELS
+// src/MavlinkCrc_pclmul.cpp, свёртка по 16 байт умножением без переносов
+uint16_t crcMcrf4xxFoldPclmul(uint16_t crc, const uint8_t* data, size_t size);
+#endif
+
+#endif // MAVLINK_CRC_H
@@ -0,0 +1,203 @@
+#ifndef MAVLINK_DISPATCHER_H
+#define MAVLINK_DISPATCHER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "mavlink.h"
+
+// Разбор сообщений MAVLink по типам вместо switch (msg.msgid) в каждом цикле приёма.
+// Обработчик подписывается на структуры сообщений C (mavlink_heartbeat_t ...), набор
+// msgid и порядок проверок известны при компиляции, каждое сообщение декодируется
+// один раз, сколько бы обработчиков на него ни было подписано
+
+// Сведения о сообщении для диспетчера, задаются MAVLINK_DISPATCH_MESSAGE
+template <typename T>
+struct MavlinkMessage;
+
+#define MAVLINK_DISPATCH_MESSAGE(name, NAME)                                                       \
+    template <>                                                                                    \
+    struct MavlinkMessage<mavlink_##name##_t>                                                      \
+    {                                                                                              \
+        static constexpr uint32_t id = MAVLINK_MSG_ID_##NAME;                                      \
+        static constexpr uint8_t length = MAVLINK_MSG_ID_##NAME##_LEN;                             \
+        static void decode(const mavlink_message_t* msg, mavlink_##name##_t* out)                  \
+        {                                                                                          \
+            mavlink_msg_##name##_decode(msg, out);                                                 \
+        }                                                                                          \
+    };                                                                                             \
+    static_assert(sizeof(mavlink_##name##_t) >= MAVLINK_MSG_ID_##NAME##_LEN &&                     \
+                      sizeof(mavlink_##name##_t) < MAVLINK_MSG_ID_##NAME##_LEN + 8,                \
+                  #name " layout")
+
+MAVLINK_DISPATCH_MESSAGE(heartbeat, HEARTBEAT);
+MAVLINK_DISPATCH_MESSAGE(autopilot_version, AUTOPILOT_VERSION);
+MAVLINK_DISPATCH_MESSAGE(command_ack, COMMAND_ACK);
+MAVLINK_DISPATCH_MESSAGE(mission_count, MISSION_COUNT);
+MAVLINK_DISPATCH_MESSAGE(mission_request, MISSION_REQUEST);
+MAVLINK_DISPATCH_MESSAGE(mission_request_int, MISSION_REQUEST_INT);
+MAVLINK_DISPATCH_MESSAGE(mission_item, MISSION_ITEM);
+MAVLINK_DISPATCH_MESSAGE(mission_item_int, MISSION_ITEM_INT);
+MAVLINK_DISPATCH_MESSAGE(mission_ack, MISSION_ACK);
+MAVLINK_DISPATCH_MESSAGE(file_transfer_protocol, FILE_TRANSFER_PROTOCOL);
+
+// Декодирование прямо из кадра mavlink_parse_buffer, без копии в mavlink_message_t
+template <typename T>
+inline void mavlinkDecode(const mavlink_frame_view_t& frame, T& out)
+{
+#if MAVLINK_NEED_BYTE_SWAP || !MAVLINK_ALIGNED_FIELDS
+    mavlink_message_t msg;
+    mavlink_frame_view_to_message(&frame, &msg);
+    MavlinkMessage<T>::decode(&msg, &out);
+#else
+    // Как mavlink_msg_*_decode: поля структуры идут в порядке полезной нагрузки (по убыванию
+    // размера, отступ только в конце), отрезанные MAVLink 2 нулевые байты в конце - нули
+    size_t len = std::min<size_t>(frame.len, MavlinkMessage<T>::length);
+    memset(&out, 0, sizeof(out));
+    memcpy(&out, frame.payload, len);
+#endif
+}
+
+// Кадр, описывающий уже собранное сообщение
+inline mavlink_frame_view_t mavlinkFrameView(const mavlink_message_t& msg)
+{
+    mavlink_frame_view_t frame;
+    _mav_frame_view_from_message(&msg, &frame);
+    return frame;
+}
+
+// Список типов сообщений
+template <typename... Msgs>
+struct MavlinkMessageList
+{
+};
+
+template <typename T, typename List>
+struct MavlinkListContains;
+
+template <typename T, typename... Msgs>
+struct MavlinkListContains<T, MavlinkMessageList<Msgs...>> : std::disjunction<std::is_same<T, Msgs>...>
+{
+};
+
+// Объединение списков без повторов, в порядке первого появления
+template <typename Result, typename... Lists>
+struct MavlinkListUnion
+{
+    typedef Result type;
+};
+
+template <typename... Done, typename... Lists>
+struct MavlinkListUnion<MavlinkMessageList<Done...>, MavlinkMessageList<>, Lists...>
+    : MavlinkListUnion<MavlinkMessageList<Done...>, Lists...>
+{
+};
+
+template <typename... Done, typename T, typename... Rest, typename... Lists>
+struct MavlinkListUnion<MavlinkMessageList<Done...>, MavlinkMessageList<T, Rest...>, Lists...>
+    : MavlinkListUnion<std::conditional_t<MavlinkListContains<T, MavlinkMessageList<Done...>>::value,
+                                          MavlinkMessageList<Done...>, MavlinkMessageList<Done..., T>>,
+                       MavlinkMessageList<Rest...>, Lists...>
+{
+};
+
+// Обработчик handler(const T&, const mavlink_frame_view_t&) или handler(const T&) для каждого T из Messages
+template <typename Messages, typename Handler>
+struct MavlinkSubscription
+{
+    typedef Messages MessageList;
+
+    Handler handler;
+
+    template <typename T>
+    void deliver(const T& decoded, const mavlink_frame_view_t& frame)
+    {
+        if constexpr (MavlinkListContains<T, Messages>::value)
+        {
+            if constexpr (std::is_invocable_v<Handler&, const T&, const mavlink_frame_view_t&>)
+                handler(decoded, frame);
+            else
+                handler(decoded);
+        }
+    }
+};
+
+template <typename T, typename Handler>
+MavlinkSubscription<MavlinkMessageList<T>, Handler> mavlinkOn(Handler handler)
+{
+    return { std::move(handler) };
+}
+
+// Подписка компонента: тип Messages и перегрузки handle(const T&, const mavlink_frame_view_t&, Clock::time_point)
+template <typename Component>
+auto mavlinkSubscribe(Component& component)
+{
+    auto handler = [&component](const auto& decoded, const mavlink_frame_view_t& frame) {
+        component.handle(decoded, frame, Component::Clock::now());
+    };
+    return MavlinkSubscription<typename Component::Messages, decltype(handler)>{ handler };
+}
+
+template <typename... Subscriptions>
+class MavlinkDispatcher
+{
+public:
+    typedef typename MavlinkListUnion<MavlinkMessageList<>, typename Subscriptions::MessageList...>::type Messages;
+
+private:
+    std::tuple<Subscriptions...> subscriptions;
+
+    template <typename T>
+    bool dispatchAs(const mavlink_frame_view_t& frame)
+    {
+        if (frame.msgid != MavlinkMessage<T>::id)
+            return false;
+
+        T decoded;
+        mavlinkDecode(frame, decoded);
+        std::apply([&](auto&... subscription) { (subscription.deliver(decoded, frame), ...); }, subscriptions);
+        return true;
+    }
+
+    template <typename... Msgs>
+    bool dispatchAny(const mavlink_frame_view_t& frame, MavlinkMessageList<Msgs...>)
+    {
+        return (dispatchAs<Msgs>(frame) || ...);
+    }
+
+public:
+    explicit MavlinkDispatcher(Subscriptions... subscriptions) : subscriptions(std::move(subscriptions)...)
+    {
+    }
+
+    // false - на это сообщение никто не подписан
+    bool dispatch(const mavlink_frame_view_t& frame)
+    {
+        return dispatchAny(frame, Messages());
+    }
+
+    bool dispatch(const mavlink_message_t& msg)
+    {
+        return dispatch(mavlinkFrameView(msg));
+    }
+};
+
+template <typename... Subscriptions>
+MavlinkDispatcher<Subscriptions...> makeMavlinkDispatcher(Subscriptions... subscriptions)
+{
+    return MavlinkDispatcher<Subscriptions...>(std::move(subscriptions)...);
+}
+
+// handleMessage компонента через его перегрузки handle
+template <typename Component>
+void mavlinkDispatchTo(Component& component, const mavlink_message_t& msg, typename Component::Clock::time_point now)
+{
+    auto handler = [&](const auto& decoded, const mavlink_frame_view_t& frame) { component.handle(decoded, frame, now); };
+    makeMavlinkDispatcher(MavlinkSubscription<typename Component::Messages, decltype(handler)>{ handler }).dispatch(msg);
+}
+
+#endif // MAVLINK_DISPATCHER_H
@@ -0,0 +1,166 @@
+#ifndef MAVLINK_FTP_H
+#define MAVLINK_FTP_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "MissionUploader.h"
+#include "WireSchema.h"
+
+// Заголовок полезной нагрузки FILE_TRANSFER_PROTOCOL (https://mavlink.io/en/services/ftp.html),
+// за ним до MAVLINK_FTP_DATA_MAX байт данных
+struct MavlinkFtpHeader
+{
+    uint16_t seq = 0;
+    uint8_t session = 0;
+    uint8_t opcode = 0;
+    uint8_t size = 0;
+    uint8_t reqOpcode = 0;
+    uint8_t burstComplete = 0;
+    uint8_t padding = 0;
+    uint32_t offset = 0;
+};
+
+template <>
+struct WireDescription<MavlinkFtpHeader>
+    : WireSchema<WireField<&MavlinkFtpHeader::seq>, WireField<&MavlinkFtpHeader::session>,
+                 WireField<&MavlinkFtpHeader::opcode>, WireField<&MavlinkFtpHeader::size>,
+                 WireField<&MavlinkFtpHeader::reqOpcode>, WireField<&MavlinkFtpHeader::burstComplete>,
+                 WireField<&MavlinkFtpHeader::padding>, WireField<&MavlinkFtpHeader::offset>>
+{
+    static constexpr const char* name = "MavlinkFtpHeader";
+};
+
+#define MAVLINK_FTP_PAYLOAD_SIZE    251
+#define MAVLINK_FTP_DATA_MAX        (MAVLINK_FTP_PAYLOAD_SIZE - 12)
+
+static_assert(wireSize<MavlinkFtpHeader>() == 12, "MavlinkFtpHeader layout");
+
+enum MavlinkFtpOpcode : uint8_t
+{
+    FTP_OP_NONE = 0,
+    FTP_OP_TERMINATE_SESSION = 1,
+    FTP_OP_RESET_SESSIONS = 2,
+    FTP_OP_LIST_DIRECTORY = 3,
+    FTP_OP_OPEN_FILE_RO = 4,
+    FTP_OP_READ_FILE = 5,
+    FTP_OP_CREATE_FILE = 6,
+    FTP_OP_WRITE_FILE = 7,
+    FTP_OP_REMOVE_FILE = 8,
+    FTP_OP_CREATE_DIRECTORY = 9,
+    FTP_OP_REMOVE_DIRECTORY = 10,
+    FTP_OP_OPEN_FILE_WO = 11,
+    FTP_OP_TRUNCATE_FILE = 12,
+    FTP_OP_RENAME = 13,
+    FTP_OP_CALC_FILE_CRC32 = 14,
+    FTP_OP_BURST_READ_FILE = 15,
+    FTP_OP_ACK = 128,
+    FTP_OP_NAK = 129
+};
+
+// Первый байт данных NAK
+enum MavlinkFtpError : uint8_t
+{
+    FTP_ERR_NONE = 0,
+    FTP_ERR_FAIL = 1,
+    FTP_ERR_FAIL_ERRNO = 2,
+    FTP_ERR_INVALID_DATA_SIZE = 3,
+    FTP_ERR_INVALID_SESSION = 4,
+    FTP_ERR_NO_SESSIONS_AVAILABLE = 5,
+    FTP_ERR_EOF = 6,
+    FTP_ERR_UNKNOWN_COMMAND = 7,
+    FTP_ERR_FILE_EXISTS = 8,
+    FTP_ERR_FILE_PROTECTED = 9,
+    FTP_ERR_FILE_NOT_FOUND = 10
+};
+
+struct MavlinkFtpResult
+{
+    bool ok = false;
+    bool timedOut = false;
+    uint8_t nakError = FTP_ERR_NONE;   // ошибка из NAK, на котором операция остановилась
+    std::vector<uint8_t> data;         // прочитанный файл
+    std::chrono::milliseconds duration{0};
+    unsigned retransmits = 0;
+};
+
+// Клиент MAVLink FTP без блокировок, тот же порядок работы, что у MissionUploader.
+// Запись идёт окном из readbackWindow запросов WriteFile, чтение - BurstReadFile:
+// автопилот сам шлёт файл пачками, после потери пачка запрашивается заново с первого
+// недостающего байта. Одна операция за раз
+class MavlinkFtpClient
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::function<void(const mavlink_message_t&)> Sender;
+    typedef MavlinkMessageList<mavlink_file_transfer_protocol_t> Messages;
+
+private:
+    enum class State { Idle, Opening, Writing, Reading, Closing };
+
+    struct Request
+    {
+        uint16_t seq;
+        uint32_t offset;
+        uint8_t size;
+    };
+
+    Sender send;
+    MissionTransferSettings settings;
+
+    State state = State::Idle;
+    bool writing = false;
+    std::string path;
+    uint8_t session = 0;
+    uint16_t seq = 0;
+
+    std::vector<uint8_t> file;         // записываемый или прочитанный файл
+    uint32_t nextOffset = 0;           // запись: первый не отправленный байт
+    std::vector<Request> inFlight;     // запись: неподтверждённые WriteFile
+    uint32_t fileSize = 0;             // чтение: размер из ответа на OpenFileRO
+    uint32_t readOffset = 0;           // чтение: всё до этого байта получено
+
+    mavlink_message_t lastMessage;     // открытие и закрытие повторяются целиком
+    unsigned retries = 0;
+    Clock::time_point started;
+    Clock::time_point retryAt;
+    Clock::time_point deadline;
+
+    std::promise<MavlinkFtpResult> promise;
+    MavlinkFtpResult result;
+
+    std::future<MavlinkFtpResult> begin(uint8_t openOpcode, const std::string& path, Clock::time_point now);
+    void transmit(uint16_t requestSeq, uint8_t opcode, uint32_t offset, const uint8_t* data, uint8_t size,
+                  Clock::time_point now);
+    void sendChunks(Clock::time_point now);
+    void requestBurst(Clock::time_point now);
+    void close(Clock::time_point now);
+    void onAck(const MavlinkFtpHeader& header, const uint8_t* data, Clock::time_point now);
+    void finish(bool ok, bool timedOut, uint8_t nakError, Clock::time_point now);
+
+public:
+    explicit MavlinkFtpClient(Sender send, const MissionTransferSettings& settings = MissionTransferSettings());
+
+    MavlinkFtpClient(const MavlinkFtpClient&) = delete;
+    MavlinkFtpClient& operator=(const MavlinkFtpClient&) = delete;
+
+    // Создаёт (или обрезает) файл path и записывает в него data
+    std::future<MavlinkFtpResult> startWrite(const std::string& path, std::vector<uint8_t> data,
+                                             Clock::time_point now = Clock::now());
+
+    std::future<MavlinkFtpResult> startRead(const std::string& path, Clock::time_point now = Clock::now());
+
+    void handleMessage(const mavlink_message_t& msg, Clock::time_point now = Clock::now());
+    void handle(const mavlink_file_transfer_protocol_t& ftp, const mavlink_frame_view_t& frame, Clock::time_point now);
+    void poll(Clock::time_point now = Clock::now());
+    void cancel(Clock::time_point now = Clock::now());
+
+    bool active() const;
+    Clock::time_point nextWakeup() const;
+};
+
+#endif // MAVLINK_FTP_H
@@ -0,0 +1,18 @@
+#ifndef MAVLINK_MSG_TABLE_H
+#define MAVLINK_MSG_TABLE_H
+
+#include <cstdint>
+
+#include "mavlink.h"
+
+// Таблицы сообщений диалекта ardupilotmega (вместе с common), собранные при компиляции.
+// С MAVLINK_GET_MSG_ENTRY библиотека берёт отсюда mavlink_get_msg_entry: поиск по
+// двухуровневой таблице страниц msgid >> 8 вместо деления пополам
+
+// По имени сообщения ("HEARTBEAT"), nullptr - нет в диалекте
+const mavlink_msg_entry_t* mavlinkMsgEntryByName(const char* name);
+
+// Имя сообщения, nullptr - нет в диалекте
+const char* mavlinkMsgName(uint32_t msgid);
+
+#endif // MAVLINK_MSG_TABLE_H
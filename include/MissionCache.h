@@ -0,0 +1,62 @@
+#ifndef MISSION_CACHE_H
+#define MISSION_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FlyPlaneData.h"
+
+#include "mavlink.h"
+#include "ardupilotmega.h"
+
+// Что сейчас загружено в автопилот: точки маршрута в раскладке Do_UpdateWayPoints
+// (пункт 0 - дом, пункт i + 1 - точка i) и CRC-32 их кодировки WGS84CoordInt с высотой,
+// округлённой до сантиметра (с такой точностью её хранит автопилот)
+class MissionCache
+{
+private:
+    std::vector<WGS84CoordInt> points;
+    uint32_t hash = 0;
+    bool valid = false;
+
+public:
+    static uint32_t hashPoints(const WGS84CoordInt* points, size_t count);
+
+    // Точка в том виде, в каком её хранит автопилот: высота округлена до сантиметра
+    static WGS84CoordInt quantize(const WGS84CoordInt& point);
+
+    // Миссия автопилота известна (прочитана или подтверждена после загрузки)
+    bool known() const;
+
+    // На автопилоте те же пункты: совпадают хеш и точки после quantize. Правка высоты
+    // меньше сантиметра автопилоту не передаётся, такой маршрут считается тем же
+    bool matches(const WGS84CoordInt* points, size_t count) const;
+
+    void assign(const WGS84CoordInt* points, size_t count);
+    void clear();
+
+    // Восстанавливает точки из пунктов, прочитанных с автопилота (items[0] - пункт 0).
+    // Пункт 0 автопилот заменяет фактической точкой дома, поэтому он не сравнивается.
+    // false - миссия составлена не нами (другие команды или системы координат)
+    bool assignItems(const mavlink_mission_item_int_t* items, size_t count);
+
+    // Допуск сравнения координат (1e-7 градуса) для пунктов, загруженных как MISSION_ITEM:
+    // float округляет долготу до 2^-16 градуса (~150 единиц), ошибка - до половины шага
+    static const int32_t FLOAT_ITEM_TOLERANCE = 100;
+
+    // Допуск сравнения прочитанной высоты (мм, строго меньше): ArduPilot хранит высоту пункта
+    // в сантиметрах, округляя или отбрасывая миллиметры, так что прочитанная высота
+    // отличается от загруженной меньше чем на 1 см
+    static const int32_t ALTITUDE_TOLERANCE = 10;
+
+    // Совпадают ли пункты first.. (items[0] - пункт first) с точками coords
+    static bool itemsMatch(const mavlink_mission_item_int_t* items, size_t count, uint16_t first,
+                           const WGS84CoordInt* coords, size_t pointCount, int32_t tolerance = 0);
+
+    const std::vector<WGS84CoordInt>& getPoints() const;
+    uint32_t getHash() const;
+    size_t size() const;
+};
+
+#endif // MISSION_CACHE_H
@@ -0,0 +1,90 @@
+#ifndef MISSION_DOWNLOADER_H
+#define MISSION_DOWNLOADER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <vector>
+
+#include "MissionUploader.h"
+
+// Итог чтения миссии: пункты first .. first + items.size() - 1
+struct MissionDownloadResult
+{
+    bool complete = false;
+    bool timedOut = false;
+    uint16_t first = 0;
+    std::vector<mavlink_mission_item_int_t> items;
+    std::chrono::milliseconds duration{0};
+    unsigned retransmits = 0;
+};
+
+// Чтение миссии с автопилота без блокировок, тот же порядок работы, что у MissionUploader.
+// Пункты запрашиваются MISSION_REQUEST_INT окном по readbackWindow штук, поэтому чтение
+// занимает порядка count / readbackWindow обменов вместо count. Ответ MISSION_ITEM
+// (float) тоже принимается и переводится в целые координаты
+class MissionDownloader
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::function<void(const mavlink_message_t&)> Sender;
+    typedef MavlinkMessageList<mavlink_mission_count_t, mavlink_mission_item_int_t, mavlink_mission_item_t,
+                               mavlink_mission_ack_t> Messages;
+
+private:
+    enum class State { Idle, WaitingCount, Receiving };
+
+    Sender send;
+    MissionTransferSettings settings;
+
+    State state = State::Idle;
+    bool listed = false;        // начато с MISSION_REQUEST_LIST, в конце нужен MISSION_ACK
+    uint16_t firstSeq = 0;
+    uint16_t lastSeq = 0;
+    uint32_t nextRequest = 0;   // следующий ещё не запрошенный пункт
+    size_t missing = 0;
+    std::vector<bool> have;
+
+    unsigned retries = 0;
+    Clock::time_point started;
+    Clock::time_point retryAt;
+    Clock::time_point deadline;
+
+    std::promise<MissionDownloadResult> promise;
+    MissionDownloadResult result;
+
+    // Сообщение от нашего автопилота и адресовано нам (автопилот ведёт обмен миссией
+    // и с другими станциями на том же канале)
+    bool accepts(const mavlink_frame_view_t& frame, uint8_t targetSystem, uint8_t targetComponent) const;
+    void begin(Clock::time_point now);
+    void receive(uint16_t count, Clock::time_point now);
+    void request(uint16_t seq);
+    void onItem(const mavlink_mission_item_int_t& item, Clock::time_point now);
+    void finish(bool complete, bool timedOut, Clock::time_point now);
+
+public:
+    explicit MissionDownloader(Sender send, const MissionTransferSettings& settings = MissionTransferSettings());
+
+    MissionDownloader(const MissionDownloader&) = delete;
+    MissionDownloader& operator=(const MissionDownloader&) = delete;
+
+    // Вся миссия: MISSION_REQUEST_LIST -> MISSION_COUNT -> пункты -> MISSION_ACK
+    std::future<MissionDownloadResult> start(Clock::time_point now = Clock::now());
+
+    // Только пункты first .. last уже загруженной миссии (проверка частичной загрузки)
+    std::future<MissionDownloadResult> startRange(uint16_t first, uint16_t last, Clock::time_point now = Clock::now());
+
+    void handleMessage(const mavlink_message_t& msg, Clock::time_point now = Clock::now());
+    void handle(const mavlink_mission_count_t& count, const mavlink_frame_view_t& frame, Clock::time_point now);
+    void handle(const mavlink_mission_item_int_t& item, const mavlink_frame_view_t& frame, Clock::time_point now);
+    void handle(const mavlink_mission_item_t& wp, const mavlink_frame_view_t& frame, Clock::time_point now);
+    void handle(const mavlink_mission_ack_t& ack, const mavlink_frame_view_t& frame, Clock::time_point now);
+    void poll(Clock::time_point now = Clock::now());
+    void cancel(Clock::time_point now = Clock::now());
+
+    bool active() const;
+    Clock::time_point nextWakeup() const;
+};
+
+#endif // MISSION_DOWNLOADER_H
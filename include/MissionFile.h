@@ -0,0 +1,59 @@
+#ifndef MISSION_FILE_H
+#define MISSION_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "WireSchema.h"
+
+#include "mavlink.h"
+
+// Файл @MISSION/mission.dat, через который ArduPilot отдаёт и принимает миссию по MAVLink FTP:
+// заголовок, за ним num_items пунктов в раскладке полезной нагрузки MISSION_ITEM_INT
+#define MISSION_FILE_PATH   "@MISSION/mission.dat"
+#define MISSION_FILE_MAGIC  0x763d
+
+struct MissionFileHeader
+{
+    uint16_t magic = MISSION_FILE_MAGIC;
+    uint16_t dataType = MAV_MISSION_TYPE_MISSION;
+    uint16_t options = 0;
+    uint16_t start = 0;       // первый пункт в файле
+    uint16_t numItems = 0;
+};
+
+template <>
+struct WireDescription<MissionFileHeader>
+    : WireSchema<WireField<&MissionFileHeader::magic>, WireField<&MissionFileHeader::dataType>,
+                 WireField<&MissionFileHeader::options>, WireField<&MissionFileHeader::start>,
+                 WireField<&MissionFileHeader::numItems>>
+{
+    static constexpr const char* name = "MissionFileHeader";
+};
+
+template <>
+struct WireDescription<mavlink_mission_item_int_t>
+    : WireSchema<WireField<&mavlink_mission_item_int_t::param1>, WireField<&mavlink_mission_item_int_t::param2>,
+                 WireField<&mavlink_mission_item_int_t::param3>, WireField<&mavlink_mission_item_int_t::param4>,
+                 WireField<&mavlink_mission_item_int_t::x>, WireField<&mavlink_mission_item_int_t::y>,
+                 WireField<&mavlink_mission_item_int_t::z>, WireField<&mavlink_mission_item_int_t::seq>,
+                 WireField<&mavlink_mission_item_int_t::command>,
+                 WireField<&mavlink_mission_item_int_t::target_system>,
+                 WireField<&mavlink_mission_item_int_t::target_component>,
+                 WireField<&mavlink_mission_item_int_t::frame>, WireField<&mavlink_mission_item_int_t::current>,
+                 WireField<&mavlink_mission_item_int_t::autocontinue>,
+                 WireField<&mavlink_mission_item_int_t::mission_type>>
+{
+    static constexpr const char* name = "MissionItemInt";
+};
+
+static_assert(wireSize<MissionFileHeader>() == 10, "MissionFileHeader layout");
+static_assert(wireSize<mavlink_mission_item_int_t>() == MAVLINK_MSG_ID_MISSION_ITEM_INT_LEN, "MissionItemInt layout");
+
+void encodeMissionFile(const mavlink_mission_item_int_t* items, size_t count, std::vector<uint8_t>& file);
+
+// false - не файл миссии или он обрезан
+bool decodeMissionFile(const uint8_t* data, size_t size, std::vector<mavlink_mission_item_int_t>& items);
+
+#endif // MISSION_FILE_H
@@ -0,0 +1,137 @@
+#ifndef MISSION_UPLOADER_H
+#define MISSION_UPLOADER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <vector>
+
+#include "FlyDefines.h"
+#include "MavlinkDispatcher.h"
+
+#include "mavlink.h"
+
+// Вариант пункта миссии, который запросил автопилот: MISSION_REQUEST_INT -> MISSION_ITEM_INT
+// (координаты целые, 1e7), устаревший MISSION_REQUEST -> MISSION_ITEM (float)
+enum class MissionItemFormat { Int, Float };
+
+// Итог одной загрузки миссии
+struct MissionUploadResult
+{
+    bool accepted = false;
+    bool timedOut = false;                     // автопилот замолчал после всех повторов или истёк общий срок
+    uint8_t ackType = MAV_MISSION_ERROR;       // MAV_MISSION_RESULT из MISSION_ACK (или наш отказ)
+    std::chrono::milliseconds duration{0};
+    unsigned retransmits = 0;                  // повторы MISSION_COUNT и пунктов по таймауту
+    unsigned duplicates = 0;                   // повторные запросы уже отправленных пунктов
+    unsigned rejected = 0;                     // запросы с seq вне миссии
+    unsigned floatItems = 0;                   // пункты, отправленные как MISSION_ITEM
+};
+
+// Накопленная статистика по всем загрузкам
+struct MissionUploadStats
+{
+    unsigned uploads = 0;
+    unsigned accepted = 0;
+    unsigned retransmits = 0;
+    std::chrono::milliseconds totalDuration{0};
+    std::chrono::milliseconds maxDuration{0};
+};
+
+// Общие параметры обмена миссией (загрузка и чтение)
+struct MissionTransferSettings
+{
+    std::chrono::milliseconds retryTimeout{MISSION_ITEM_TIMEOUT_MS};
+    unsigned maxRetries = MISSION_MAX_RETRIES;
+    std::chrono::milliseconds deadline{MISSION_UPLOAD_TIMEOUT_MS};
+    unsigned readbackWindow = MISSION_READBACK_WINDOW;  // запросов пунктов в полёте при чтении
+
+    uint8_t systemId = 255;
+    uint8_t componentId = MAV_COMP_ID_ONBOARD_COMPUTER;
+    uint8_t targetSystem = 1;
+    uint8_t targetComponent = 1;
+};
+
+// Загрузка миссии по протоколу MAVLink без блокировок: владелец передаёт разобранные
+// сообщения в handleMessage (или подписывает загрузчик на MavlinkDispatcher, см.
+// mavlinkSubscribe) и вызывает poll не позже nextWakeup(). Пока запросов нет,
+// последнее сообщение (MISSION_COUNT или пункт) повторяется каждые retryTimeout.
+// Запросы принимаются в любом порядке и повторно; итог приходит в future и callback.
+// Не потокобезопасен: все вызовы из одного потока
+class MissionUploader
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::function<void(const mavlink_message_t&)> Sender;
+    // Собирает пункт миссии seq в запрошенном варианте, false - пункта нет
+    typedef std::function<bool(uint16_t, MissionItemFormat, mavlink_message_t&)> ItemSource;
+    typedef std::function<void(const MissionUploadResult&)> Callback;
+    typedef MavlinkMessageList<mavlink_mission_request_t, mavlink_mission_request_int_t, mavlink_mission_ack_t> Messages;
+
+private:
+    enum class State { Idle, SendingCount, SendingItems };
+
+    Sender send;
+    MissionTransferSettings settings;
+    Callback callback;
+
+    State state = State::Idle;
+    ItemSource itemAt;
+    uint16_t firstSeq = 0;   // запрашиваемые пункты firstSeq .. lastSeq
+    uint16_t lastSeq = 0;
+    std::vector<bool> sent;
+
+    mavlink_message_t lastMessage;
+    unsigned retries = 0;
+    Clock::time_point started;
+    Clock::time_point retryAt;
+    Clock::time_point deadline;
+
+    std::promise<MissionUploadResult> promise;
+    MissionUploadResult result;
+    MissionUploadStats totals;
+
+    std::future<MissionUploadResult> begin(const mavlink_message_t& announce, uint16_t first, uint16_t last,
+                                           ItemSource source, Clock::time_point now);
+    void transmit(const mavlink_message_t& msg, Clock::time_point now);
+    // Сообщение от нашего автопилота и адресовано нам (автопилот ведёт обмен миссией
+    // и с другими станциями на том же канале)
+    bool accepts(const mavlink_frame_view_t& frame, uint8_t targetSystem, uint8_t targetComponent) const;
+    void onRequest(uint16_t seq, MissionItemFormat format, Clock::time_point now);
+    void abort(bool timedOut, Clock::time_point now);
+    void finish(uint8_t ackType, bool timedOut, Clock::time_point now);
+
+public:
+    explicit MissionUploader(Sender send, const MissionTransferSettings& settings = MissionTransferSettings());
+
+    MissionUploader(const MissionUploader&) = delete;
+    MissionUploader& operator=(const MissionUploader&) = delete;
+
+    // Начинает загрузку itemCount пунктов (seq 0 .. itemCount - 1), незавершённая отменяется
+    std::future<MissionUploadResult> start(uint16_t itemCount, ItemSource itemAt, Clock::time_point now = Clock::now());
+
+    // Заменяет пункты first .. last (включительно) загруженной миссии через MISSION_WRITE_PARTIAL_LIST,
+    // остальные пункты и их число автопилот сохраняет
+    std::future<MissionUploadResult> startPartial(uint16_t first, uint16_t last, ItemSource itemAt,
+                                                  Clock::time_point now = Clock::now());
+
+    void onComplete(Callback callback);
+
+    void handleMessage(const mavlink_message_t& msg, Clock::time_point now = Clock::now());
+    void handle(const mavlink_mission_request_t& req, const mavlink_frame_view_t& frame, Clock::time_point now);
+    void handle(const mavlink_mission_request_int_t& req, const mavlink_frame_view_t& frame, Clock::time_point now);
+    void handle(const mavlink_mission_ack_t& ack, const mavlink_frame_view_t& frame, Clock::time_point now);
+    void poll(Clock::time_point now = Clock::now());
+
+    // Отменяет загрузку и сообщает автопилоту MAV_MISSION_OPERATION_CANCELLED
+    void cancel(Clock::time_point now = Clock::now());
+
+    bool active() const;
+    Clock::time_point nextWakeup() const;
+
+    const MissionUploadResult& lastResult() const;
+    const MissionUploadStats& stats() const;
+};
+
+#endif // MISSION_UPLOADER_H
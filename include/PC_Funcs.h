@@ -2,22 +2,31 @@
 #define PC_FUNCS_H
 
 #include "FlyPlaneData.h"
+#include "RouteCodec.h"
+#include "RouteStore.h"
+#include "PayloadProtection.h"
+#include "WireFormat.h"
+#include "ImageFrame.h"
 #include "InterfaceTCP.h"
 #include "FlyDefines.h"
 
 #include <chrono>
 #include <thread>
+#include <functional>
+#include <vector>
 
 #include <iostream>
 #include <fstream>
 
 WGS84Coord* tryReadCoords(int& count);
+// Маршрут из ROUTE_STORE_FILE или coords.txt; прочитанный файл удаляется
+bool tryReadRoute(FlyPlaneData& data);
 
 bool savePNG(unsigned char* image, int imageSize, const char* filename);
 
-void sendCoords(InterfaceTCPClient tmp);
+void sendCoords(InterfaceTCPClient &tmp);
 
-void recvImage(InterfaceTCPServer tmp);
+void recvImage(InterfaceTCPServer &tmp);
 
 void PC_func(void);
 
@@ -0,0 +1,107 @@
+#ifndef PAYLOAD_PROTECTION_H
+#define PAYLOAD_PROTECTION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "ChaCha20Poly1305.h"
+
+// Потоковое открытие сообщения: данные расшифровываются по мере приёма, но считаются
+// подлинными только после успешного finish
+class PayloadStream
+{
+public:
+    virtual ~PayloadStream() = default;
+
+    virtual void update(unsigned char* data, size_t size) = 0;
+    virtual bool finish(const unsigned char* suffix) = 0;
+};
+
+// Защита полезной нагрузки маршрутов и кадров. Сообщение на проводе:
+//   prefix (prefixSize байт) | зашифрованные данные | suffix (suffixSize байт)
+class PayloadProtector
+{
+public:
+    virtual ~PayloadProtector() = default;
+
+    virtual size_t prefixSize() const = 0;
+    virtual size_t suffixSize() const = 0;
+    size_t overhead() const { return prefixSize() + suffixSize(); }
+
+    // message: prefixSize() + size + suffixSize() байт, открытые данные лежат после префикса
+    virtual void seal(unsigned char* message, size_t size) = 0;
+
+    // Проверяет и расшифровывает на месте. false - сообщение повреждено или подделано,
+    // данные при этом не расшифровываются
+    virtual bool open(unsigned char* message, size_t messageSize) = 0;
+
+    // Расшифровка первых size байт без проверки - только чтобы узнать длину сообщения
+    virtual void peek(const unsigned char* message, unsigned char* out, size_t size) const = 0;
+
+    // Открытие по частям без буфера на всё сообщение, prefix - первые prefixSize() байт
+    virtual std::unique_ptr<PayloadStream> openStream(const unsigned char* prefix) = 0;
+};
+
+// Прежняя защита: XOR с повторяющимся ключом, без контроля целостности
+class XorProtector : public PayloadProtector
+{
+private:
+    const char* key;
+
+public:
+    explicit XorProtector(const char* key = "uav");
+
+    size_t prefixSize() const override;
+    size_t suffixSize() const override;
+    void seal(unsigned char* message, size_t size) override;
+    bool open(unsigned char* message, size_t messageSize) override;
+    void peek(const unsigned char* message, unsigned char* out, size_t size) const override;
+    std::unique_ptr<PayloadStream> openStream(const unsigned char* prefix) override;
+
+    void apply(unsigned char* data, size_t size, size_t offset = 0) const;
+};
+
+// Защита без ключа: любое сообщение отклоняется, исходящие данные стираются,
+// чтобы не уйти открытыми
+class NoKeyProtector : public PayloadProtector
+{
+public:
+    size_t prefixSize() const override;
+    size_t suffixSize() const override;
+    void seal(unsigned char* message, size_t size) override;
+    bool open(unsigned char* message, size_t messageSize) override;
+    void peek(const unsigned char* message, unsigned char* out, size_t size) const override;
+    std::unique_ptr<PayloadStream> openStream(const unsigned char* prefix) override;
+};
+
+// ChaCha20-Poly1305: nonce (8 случайных байт процесса + счётчик 32 бит) | шифртекст | тег
+class ChaCha20Poly1305Protector : public PayloadProtector
+{
+private:
+    uint8_t key[CHACHA20_KEY_SIZE];
+    uint8_t noncePrefix[8];
+    std::atomic<uint32_t> counter{0};
+
+public:
+    explicit ChaCha20Poly1305Protector(const uint8_t key[CHACHA20_KEY_SIZE]);
+    ~ChaCha20Poly1305Protector();
+
+    // Файл с ключом: 32 байта как есть или 64 шестнадцатеричных символа
+    static std::unique_ptr<ChaCha20Poly1305Protector> fromKeyFile(const char* path);
+
+    size_t prefixSize() const override;
+    size_t suffixSize() const override;
+    void seal(unsigned char* message, size_t size) override;
+    bool open(unsigned char* message, size_t messageSize) override;
+    void peek(const unsigned char* message, unsigned char* out, size_t size) const override;
+    std::unique_ptr<PayloadStream> openStream(const unsigned char* prefix) override;
+};
+
+// Текущая защита. По умолчанию ChaCha20-Poly1305 с ключом из PAYLOAD_KEY_FILE,
+// если файл есть, иначе NoKeyProtector (XorProtector при PAYLOAD_ALLOW_XOR_FALLBACK)
+PayloadProtector& payloadProtector();
+void setPayloadProtector(std::unique_ptr<PayloadProtector> protector);
+
+#endif // PAYLOAD_PROTECTION_H
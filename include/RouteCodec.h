@@ -0,0 +1,49 @@
+#ifndef ROUTE_CODEC_H
+#define ROUTE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "FlyPlaneData.h"
+
+// Флаги заголовка маршрута
+#define ROUTE_FLAG_DELTA_VARINT 0x01 // первая точка целиком, далее zigzag-varint разности lat/lon/alt
+
+// Согласованность полей заголовка: известные флаги, размер несжатых точек
+bool checkRouteHeader(const RouteHeader& header);
+
+// Размер полезной нагрузки в выбранной кодировке
+size_t routePayloadSize(const WGS84CoordInt* points, int count, uint8_t flags);
+
+// Кодирует точки в out (не меньше routePayloadSize байт), возвращает конец записанных данных
+unsigned char* encodeRoutePayload(const WGS84CoordInt* points, int count, uint8_t flags, unsigned char* out);
+
+// Последовательное чтение точек из полезной нагрузки любой поддерживаемой кодировки
+class RoutePointReader
+{
+private:
+    const unsigned char* ptr;
+    const unsigned char* end;
+    uint8_t flags;
+    uint32_t index = 0;
+    uint32_t count;
+    WGS84CoordInt last;
+
+public:
+    RoutePointReader(const unsigned char* payload, size_t size, uint32_t count, uint8_t flags);
+
+    // false - точки закончились или данные повреждены (см. failed)
+    bool next(WGS84CoordInt& point);
+    bool failed() const;
+    uint32_t position() const;
+
+    // Продолжение чтения с нового фрагмента при потоковом приёме: номер точки и
+    // предыдущая точка для разностей сохраняются
+    void resume(const unsigned char* payload, size_t size);
+    const unsigned char* current() const;
+};
+
+// Наибольший размер одной закодированной точки
+#define ROUTE_MAX_POINT_SIZE 15
+
+#endif // ROUTE_CODEC_H
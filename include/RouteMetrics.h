@@ -0,0 +1,47 @@
+#ifndef ROUTE_METRICS_H
+#define ROUTE_METRICS_H
+
+#include <cstddef>
+#include <vector>
+
+#include "FlyPlaneData.h"
+
+// Маршрут в виде структуры массивов: широта и долгота в радианах, высота в метрах
+struct RouteSoA
+{
+    std::vector<double> lat, lon, alt;
+
+    void assign(const WGS84CoordInt* points, int count);
+    void assign(const FlyPlaneData& route);
+    size_t size() const;
+};
+
+// Характеристики участков i -> i + 1 и маршрута в целом. Расстояния - по сфере
+// среднего радиуса (гаверсинус): относительно эллипсоида WGS84 ошибка до 0.5%
+struct RouteMetrics
+{
+    std::vector<double> legLength; // горизонтальная длина, м
+    std::vector<double> bearing;   // начальный азимут, градусы 0..360
+    std::vector<double> climbRate; // вертикальная скорость при полёте со скоростью speed, м/с
+
+    double totalDistance = 0;      // сумма горизонтальных длин, м
+    double flightTime = 0;         // по наклонной длине участков, с
+    double maxClimbRate = 0;
+    double maxDescentRate = 0;     // положительное число
+};
+
+// Расхождение computeRouteMetrics с computeRouteMetricsScalar (bench/RouteMetricsBench.cpp).
+// Ядра считают sin/cos/atan2 рядами с ошибкой ~1e-15 (GeodesyKernel.h), на проверочном
+// маршрутах длина участка расходится до 7e-8 м, азимут до 3e-6 градуса; допуски взяты с запасом.
+// Азимут участков короче 1 мм не определён и не сравнивается
+const double ROUTE_METRICS_LENGTH_TOLERANCE = 1e-6;     // м
+const double ROUTE_METRICS_RELATIVE_TOLERANCE = 1e-13;  // доля длины участков длиннее 1 м
+const double ROUTE_METRICS_BEARING_TOLERANCE = 1e-5;    // градусы
+
+// Векторные ядра (SSE2/NEON, AVX2 при поддержке процессором)
+void computeRouteMetrics(const RouteSoA& route, double speed, RouteMetrics& metrics);
+
+// Скалярный вариант через libm - эталон для проверки и сравнения скорости
+void computeRouteMetricsScalar(const RouteSoA& route, double speed, RouteMetrics& metrics);
+
+#endif // ROUTE_METRICS_H
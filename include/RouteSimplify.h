@@ -0,0 +1,24 @@
+#ifndef ROUTE_SIMPLIFY_H
+#define ROUTE_SIMPLIFY_H
+
+#include "FlyPlaneData.h"
+
+enum class SimplifyMethod
+{
+    DouglasPeucker,
+    VisvalingamWhyatt
+};
+
+struct SimplifyResult
+{
+    int removed = 0;
+    double maxDeviation = 0; // метры, наибольшее отклонение удалённой точки от нового отрезка
+};
+
+// Прореживание маршрута перед выгрузкой: удаляются точки, отклоняющиеся от отрезка
+// между оставшимися соседями не больше чем на toleranceM метров (с учётом высоты).
+// Первая и последняя точки сохраняются, toleranceM <= 0 оставляет маршрут как есть
+SimplifyResult simplifyRoute(FlyPlaneData& route, double toleranceM,
+                             SimplifyMethod method = SimplifyMethod::DouglasPeucker);
+
+#endif // ROUTE_SIMPLIFY_H
@@ -0,0 +1,59 @@
+#ifndef ROUTE_STORE_H
+#define ROUTE_STORE_H
+
+#include <cstddef>
+#include <string>
+
+#include "FlyPlaneData.h"
+#include "FlyPlaneDataView.h"
+
+// Файл маршрута: заголовок RouteHeader и точки lat/lon/alt int32 little-endian без
+// шифрования и сжатия - тот же формат, что внутри сообщения FlyPlaneData с flags = 0.
+// Запись во временный файл и rename: читатель видит либо старый, либо новый маршрут целиком
+bool writeRouteFile(const char* path, const WGS84CoordInt* points, int count);
+
+// Маршрут, отображённый в память только для чтения. Точки читаются прямо из файла через view()
+class MappedRouteFile
+{
+private:
+    void* data = nullptr;
+    size_t size = 0;
+    FlyPlaneDataView routeView;
+
+public:
+    MappedRouteFile() = default;
+    ~MappedRouteFile();
+
+    MappedRouteFile(const MappedRouteFile&) = delete;
+    MappedRouteFile& operator=(const MappedRouteFile&) = delete;
+
+    // false - файла нет или он повреждён (заголовок, CRC)
+    bool open(const char* path);
+    void close();
+
+    const FlyPlaneDataView& view() const;
+};
+
+// Ожидание записи файлов в каталоге через inotify, без опроса
+class RouteFileWatcher
+{
+private:
+    int inotifyFd = -1;
+    int watchFd = -1;
+    std::string directory;
+
+public:
+    explicit RouteFileWatcher(const char* directory = ".");
+    ~RouteFileWatcher();
+
+    RouteFileWatcher(const RouteFileWatcher&) = delete;
+    RouteFileWatcher& operator=(const RouteFileWatcher&) = delete;
+
+    bool isValid() const;
+
+    // Ждёт, пока в каталоге не будет дописан или переименован в него файл с одним из имён.
+    // Возвращает индекс имени или -1 по таймауту/ошибке
+    int wait(const char* const* names, int count, int timeoutMs);
+};
+
+#endif // ROUTE_STORE_H
@@ -0,0 +1,71 @@
+#ifndef ROUTE_STREAM_DECODER_H
+#define ROUTE_STREAM_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "FlyPlaneData.h"
+#include "RouteCodec.h"
+#include "PayloadProtection.h"
+
+// Потоковый разбор сообщения маршрута: фрагменты любого размера подаются по мере
+// приёма, точки сразу добавляются в route. Целиком сообщение в памяти не хранится.
+// Маршрут действителен только после done(); при ошибке он очищается.
+class RouteStreamDecoder
+{
+private:
+    enum class Stage
+    {
+        Prefix,
+        Header,
+        Payload,
+        Suffix,
+        Done,
+        Failed
+    };
+
+    FlyPlaneData& route;
+    PayloadProtector& protector;
+    std::unique_ptr<PayloadStream> stream;
+
+    Stage stage = Stage::Prefix;
+    std::vector<unsigned char> scratch; // префикс, заголовок или суффикс, пока они не собраны
+    size_t headerNeed = sizeof(int32_t);
+
+    RouteHeader header;
+    bool legacy = false;
+    uint32_t pointCount = 0;
+    size_t payloadLeft = 0;
+    size_t totalSize = 0;
+    uint32_t crc = 0;
+
+    RoutePointReader reader{nullptr, 0, 0, 0};
+    // Начало точки, разрезанной границей фрагментов
+    unsigned char carry[2 * ROUTE_MAX_POINT_SIZE];
+    size_t carried = 0;
+
+    size_t gather(unsigned char* data, size_t size, size_t target, bool decrypt);
+    bool parseHeader();
+    bool startPayload(size_t payloadSize);
+    bool decodePayload(const unsigned char* data, size_t size, bool last);
+    bool nextPoint(const unsigned char*& ptr, const unsigned char* end);
+    bool finishPayload();
+    long fail();
+
+public:
+    explicit RouteStreamDecoder(FlyPlaneData& route, PayloadProtector& protector = payloadProtector());
+
+    // Принимает очередной фрагмент, расшифровывая его на месте. Возвращает число
+    // использованных байт (байты после конца сообщения не трогаются) или -1 при ошибке
+    long feed(unsigned char* data, size_t size);
+
+    bool done() const;
+    bool failed() const;
+
+    // Полный размер сообщения, 0 пока заголовок не разобран
+    size_t messageSize() const;
+};
+
+#endif // ROUTE_STREAM_DECODER_H
@@ -3,29 +3,60 @@
 
 #include "FlyDefines.h"
 #include "FlyPlaneData.h"
+#include "PayloadProtection.h"
+#include "RouteSimplify.h"
+#include "RouteMetrics.h"
+#include "Geofence.h"
+#include "MissionUploader.h"
+#include "MissionDownloader.h"
+#include "MissionCache.h"
+#include "MissionFile.h"
+#include "MavlinkFtp.h"
+#include "MavlinkChannel.h"
+#include "MavlinkDispatcher.h"
+#include "WireFormat.h"
+#include "ImageFrame.h"
 #include "InterfaceUDP.h"
 #include "InterfaceTCP.h"
 #include "CameraCapture.h"
 
 #include <chrono>
 #include <thread>
+#include <functional>
+#include <vector>
 
 #include "mavlink.h"
 #include "ardupilotmega.h"
 
 void missionCountPack(mavlink_message_t &msg, int count);
 
-void missionWPTPack(mavlink_mission_item_t &wp, WGS84Coord coord, int seq);
+void missionWPTPack(mavlink_mission_item_t &wp, const WGS84CoordInt &coord, int seq);
 
-void sendMavlinkMessage(InterfaceUDP &sitl, const mavlink_message_t& msg);
+void missionWPTIntPack(mavlink_mission_item_int_t &wp, const WGS84CoordInt &coord, int seq);
 
-void Do_SetWayPoints(InterfaceUDP &sitl, WGS84Coord* coords, int count);
+void sendMavlinkMessage(InterfaceUDP &sitl, MavlinkChannel &channel, const mavlink_message_t& msg);
 
-void waitHeartBeat(InterfaceUDP &sitl);
+// Поддерживает ли автопилот MAVLink FTP (флаг в AUTOPILOT_VERSION)
+bool Do_QueryFtpSupport(InterfaceUDP &sitl, MavlinkChannel &channel,
+                        std::chrono::milliseconds timeout = std::chrono::milliseconds(HEARTBEAT_TIMEOUT_MS));
 
-void sendImage(InterfaceTCPClient tmp);
+// Читает миссию автопилота в cache (false - автопилот не ответил), с useFtp - файлом mission.dat
+bool Do_ReadMission(InterfaceUDP &sitl, MavlinkChannel &channel, MissionCache &cache, bool useFtp = false,
+                    std::chrono::milliseconds timeout = std::chrono::milliseconds(MISSION_UPLOAD_TIMEOUT_MS));
 
-void recvCoords(InterfaceTCPServer tmp);
+// Загружает маршрут с учётом миссии на автопилоте: совпадающий пропускается, при том же числе
+// точек уходит только изменившийся участок (MISSION_WRITE_PARTIAL_LIST), иначе - вся миссия.
+// С useFtp полная загрузка от MISSION_FTP_MIN_POINTS точек идёт файлом по MAVLink FTP.
+// Загруженное проверяется чтением, cache обновляется по итогу
+bool Do_UpdateWayPoints(InterfaceUDP &sitl, MavlinkChannel &channel, const WGS84CoordInt* coords, int count,
+                        MissionCache &cache, bool useFtp = false, std::chrono::milliseconds timeout = std::chrono::milliseconds(MISSION_UPLOAD_TIMEOUT_MS));
+
+bool waitHeartBeat(InterfaceUDP &sitl, MavlinkChannel &channel,
+                   std::chrono::milliseconds timeout = std::chrono::milliseconds(HEARTBEAT_TIMEOUT_MS));
+
+void sendImage(InterfaceTCPClient &tmp);
+
+void recvCoords(InterfaceTCPServer &tmp);
 
 int UAV_func();
 
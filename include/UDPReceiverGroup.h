@@ -0,0 +1,52 @@
+#ifndef UDP_RECEIVER_GROUP_H
+#define UDP_RECEIVER_GROUP_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "InterfaceUDP.h"
+
+// Как ядро выбирает сокет группы для входящей датаграммы
+enum class SteeringMode
+{
+	Kernel,         // стандартный хэш ядра по 4-tuple
+	SourceAddress,  // IPv4-адрес отправителя по модулю числа сокетов
+	MavlinkSysId    // sysid из заголовка MAVLink v1/v2: один аппарат - один поток
+};
+
+// N сокетов SO_REUSEPORT на одном порту, по одному рабочему потоку на сокет.
+// Обработчик вызывается в потоке worker, поэтому состояние разбора MAVLink для
+// аппаратов этого потока можно держать без блокировок, проиндексировав по worker.
+class UDPReceiverGroup
+{
+public:
+	using Handler = std::function<void(int worker, InterfaceUDP& socket, UDPDatagram& datagram)>;
+
+	UDPReceiverGroup(int port, int workers, SteeringMode steering = SteeringMode::MavlinkSysId);
+	~UDPReceiverGroup();
+
+	UDPReceiverGroup(const UDPReceiverGroup&) = delete;
+	UDPReceiverGroup& operator=(const UDPReceiverGroup&) = delete;
+
+	bool start(Handler handler, bool pinThreads = true);
+	void stop();
+
+	int size() const;
+	InterfaceUDP& socket(int worker);
+
+private:
+	int port;
+	SteeringMode steering;
+	std::vector<std::unique_ptr<InterfaceUDP>> sockets;
+	std::vector<std::thread> threads;
+	std::atomic<bool> running{false};
+	Handler handler;
+
+	bool attachSteering();
+	void workerLoop(int worker);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef WIRE_FORMAT_H
+#define WIRE_FORMAT_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Все многобайтовые поля на проводе - little-endian фиксированной ширины,
+// независимо от архитектуры отправителя и получателя
+
+inline void putLE16(unsigned char* p, uint16_t v)
+{
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+}
+
+inline void putLE32(unsigned char* p, uint32_t v)
+{
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+    p[2] = static_cast<unsigned char>(v >> 16);
+    p[3] = static_cast<unsigned char>(v >> 24);
+}
+
+inline uint16_t getLE16(const unsigned char* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t getLE32(const unsigned char* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// CRC-32 (IEEE 802.3, как в zlib). crc32Update можно вызывать по частям, начиная с 0
+uint32_t crc32Update(uint32_t crc, const unsigned char* data, size_t size);
+
+inline uint32_t crc32(const unsigned char* data, size_t size)
+{
+    return crc32Update(0, data, size);
+}
+
+#endif // WIRE_FORMAT_H
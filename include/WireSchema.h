@@ -0,0 +1,216 @@
+#ifndef WIRE_SCHEMA_H
+#define WIRE_SCHEMA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Сериализация по схеме, описанной один раз на этапе компиляции (по образцу MsgMap из
+// Mavlink_Lib/msgmap.hpp). Сообщение объявляет поля специализацией WireDescription:
+//
+//   template <> struct WireDescription<ImageHeader>
+//       : WireSchema<WireField<&ImageHeader::size>, WireField<&ImageHeader::sequence>>
+//   {
+//       static constexpr const char* name = "ImageHeader";
+//   };
+//
+// и получает wireEncode/wireDecode без выделения памяти (смещения полей - константы
+// времени компиляции), wireSize<T>() и wireSchemaHash<T>(). Поля - little-endian,
+// format - та же раскладка в нотации модуля struct языка Python ("<IBBH...").
+
+// Беззнаковый тип той же ширины (для перечислений - от базового типа)
+template <typename T, bool IsEnum = std::is_enum<T>::value>
+struct WireBits
+{
+    typedef typename std::make_unsigned<T>::type Type;
+};
+
+template <typename T>
+struct WireBits<T, true>
+{
+    typedef typename std::make_unsigned<typename std::underlying_type<T>::type>::type Type;
+};
+
+// Кодирование одного скалярного поля
+template <typename T, typename Enable = void>
+struct WireCodec;
+
+template <typename T>
+struct WireCodec<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type>
+{
+    typedef typename WireBits<T>::Type Bits;
+
+    static constexpr size_t size = sizeof(T);
+    static constexpr char code = (std::is_enum<T>::value || std::is_unsigned<T>::value)
+        ? (sizeof(T) == 1 ? 'B' : sizeof(T) == 2 ? 'H' : sizeof(T) == 4 ? 'I' : 'Q')
+        : (sizeof(T) == 1 ? 'b' : sizeof(T) == 2 ? 'h' : sizeof(T) == 4 ? 'i' : 'q');
+
+    // На little-endian хосте поле копируется одной инструкцией
+    static void put(unsigned char* p, T value)
+    {
+        Bits bits = static_cast<Bits>(value);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        memcpy(p, &bits, sizeof(bits));
+#else
+        for (size_t i = 0; i < sizeof(Bits); ++i)
+            p[i] = static_cast<unsigned char>(bits >> (8 * i));
+#endif
+    }
+
+    static T get(const unsigned char* p)
+    {
+        Bits bits = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        memcpy(&bits, p, sizeof(bits));
+#else
+        for (size_t i = 0; i < sizeof(Bits); ++i)
+            bits |= static_cast<Bits>(static_cast<Bits>(p[i]) << (8 * i));
+#endif
+        return static_cast<T>(bits);
+    }
+};
+
+template <typename T>
+struct WireCodec<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type Bits;
+
+    static constexpr size_t size = sizeof(T);
+    static constexpr char code = sizeof(T) == 4 ? 'f' : 'd';
+
+    static void put(unsigned char* p, T value)
+    {
+        Bits bits;
+        memcpy(&bits, &value, sizeof(bits));
+        WireCodec<Bits>::put(p, bits);
+    }
+
+    static T get(const unsigned char* p)
+    {
+        Bits bits = WireCodec<Bits>::get(p);
+        T value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+template <typename M>
+struct WireMember;
+
+template <typename S, typename T>
+struct WireMember<T S::*>
+{
+    typedef S Struct;
+    typedef T Type;
+};
+
+// Поле сообщения - указатель на член структуры
+template <auto Member>
+struct WireField
+{
+    typedef typename WireMember<decltype(Member)>::Type Type;
+    typedef WireCodec<Type> Codec;
+
+    static constexpr size_t size = Codec::size;
+    static constexpr char code = Codec::code;
+
+    template <typename S>
+    static void encode(const S& message, unsigned char* p)
+    {
+        Codec::put(p, message.*Member);
+    }
+
+    template <typename S>
+    static void decode(S& message, const unsigned char* p)
+    {
+        message.*Member = Codec::get(p);
+    }
+};
+
+// Поля со смещениями, вычисленными при компиляции
+template <size_t Offset, typename... Fields>
+struct WireFieldsAt
+{
+    template <typename S>
+    static void encode(const S&, unsigned char*) {}
+
+    template <typename S>
+    static void decode(S&, const unsigned char*) {}
+};
+
+template <size_t Offset, typename Field, typename... Rest>
+struct WireFieldsAt<Offset, Field, Rest...>
+{
+    template <typename S>
+    static void encode(const S& message, unsigned char* out)
+    {
+        Field::encode(message, out + Offset);
+        WireFieldsAt<Offset + Field::size, Rest...>::encode(message, out);
+    }
+
+    template <typename S>
+    static void decode(S& message, const unsigned char* in)
+    {
+        Field::decode(message, in + Offset);
+        WireFieldsAt<Offset + Field::size, Rest...>::decode(message, in);
+    }
+};
+
+template <typename... Fields>
+struct WireSchema
+{
+    static constexpr size_t size = (Fields::size + ... + 0);
+    static constexpr char format[] = { '<', Fields::code..., '\0' };
+
+    template <typename S>
+    static void encode(const S& message, unsigned char* out)
+    {
+        WireFieldsAt<0, Fields...>::encode(message, out);
+    }
+
+    template <typename S>
+    static void decode(S& message, const unsigned char* in)
+    {
+        WireFieldsAt<0, Fields...>::decode(message, in);
+    }
+};
+
+// Описание полей сообщения T, специализируется для каждого сообщения
+template <typename T>
+struct WireDescription;
+
+template <typename T>
+constexpr size_t wireSize()
+{
+    return WireDescription<T>::size;
+}
+
+// Возвращает указатель на байт после сообщения
+template <typename T>
+inline unsigned char* wireEncode(const T& message, unsigned char* out)
+{
+    WireDescription<T>::encode(message, out);
+    return out + wireSize<T>();
+}
+
+template <typename T>
+inline const unsigned char* wireDecode(T& message, const unsigned char* in)
+{
+    WireDescription<T>::decode(message, in);
+    return in + wireSize<T>();
+}
+
+constexpr uint32_t wireFnv1a(const char* text, uint32_t hash = 2166136261u)
+{
+    return *text ? wireFnv1a(text + 1, (hash ^ static_cast<unsigned char>(*text)) * 16777619u) : hash;
+}
+
+// FNV-1a имени и раскладки полей: меняется при любом изменении типов или порядка полей
+template <typename T>
+constexpr uint32_t wireSchemaHash()
+{
+    return wireFnv1a(WireDescription<T>::format, wireFnv1a(WireDescription<T>::name));
+}
+
+#endif // WIRE_SCHEMA_H
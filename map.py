@@ -13,6 +13,7 @@ import webbrowser
 import time
 import imghdr
 import datetime
+import zlib
 from urllib.parse import urlparse, parse_qs
 
 HOST = "127.0.0.1"
@@ -29,6 +30,12 @@ IMAGE_TCP_PORT = int(os.environ.get("IMAGE_TCP_PORT", str(DEFAULT_IMAGE_TCP_PORT
 IMAGE_TCP_BIND = "0.0.0.0"
 COORD_TCP_BIND = "10.147.17.150"
 
+# ChaCha20-Poly1305 key shared with the UAV (32 raw bytes or 64 hex digits), see PAYLOAD_KEY_FILE
+PAYLOAD_KEY_FILE = os.environ.get("PAYLOAD_KEY_FILE", "payload.key")
+# Without the key file routes and images are refused, as on the UAV. "1" - old XOR without
+# integrity check, only together with PAYLOAD_ALLOW_XOR_FALLBACK 1 in include/FlyDefines.h
+PAYLOAD_ALLOW_XOR_FALLBACK = os.environ.get("PAYLOAD_ALLOW_XOR_FALLBACK", "0") == "1"
+
 # Directory of this script
 SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
 
@@ -87,6 +94,8 @@ def mavlink_listener(bind_addr: str, port: int):
                     "type": mtype
                 }
 
+IMAGE_HEADER = struct.Struct('<IIQ')
+
 def recv_exact(sock, size):
     data = b''
     while len(data) < size:
@@ -96,6 +105,97 @@ def recv_exact(sock, size):
         data += chunk
     return data
 
+class PayloadProtection:
+    """Защита маршрутов и кадров, как PayloadProtector в include/PayloadProtection.h:
+    nonce (12 байт) | шифртекст | тег (16 байт) при наличии ключа. Без ключа, как
+    NoKeyProtector, ничего не шифрует и не принимает (XOR с "uav" только при
+    PAYLOAD_ALLOW_XOR_FALLBACK)."""
+
+    XOR_KEY = b"uav"
+
+    def __init__(self, key_file: str = PAYLOAD_KEY_FILE, allow_xor: bool = PAYLOAD_ALLOW_XOR_FALLBACK):
+        self.aead = None
+        self.xor = False
+        self.nonce_prefix = os.urandom(8)
+        self.counter = 0
+        self.lock = threading.Lock()
+
+        key = self._load_key(key_file)
+        if key is None:
+            if allow_xor:
+                self.xor = True
+                print(f"Payload protection: {key_file} not found, falling back to XOR without integrity check")
+            else:
+                print(f"Payload protection: {key_file} not found, routes and images are refused", file=sys.stderr)
+            return
+        try:
+            from cryptography.hazmat.primitives.ciphers.aead import ChaCha20Poly1305
+        except ImportError:
+            # С ключом БПЛА ждёт ChaCha20-Poly1305, XOR он не примет
+            print("Payload protection: 'cryptography' is not installed, routes and images are refused "
+                  "(pip install cryptography)", file=sys.stderr)
+            return
+        self.aead = ChaCha20Poly1305(key)
+        print(f"Payload protection: ChaCha20-Poly1305 ({key_file})")
+
+    def enabled(self) -> bool:
+        return self.aead is not None or self.xor
+
+    @staticmethod
+    def _load_key(key_file: str):
+        try:
+            with open(key_file, 'rb') as f:
+                content = f.read()
+        except OSError:
+            return None
+        if len(content) == 32:
+            return content
+        try:
+            key = bytes.fromhex(content.decode('ascii').strip())
+        except ValueError:
+            key = b''
+        if len(key) != 32:
+            print(f"Invalid key file {key_file}: expected 32 bytes or 64 hex digits")
+            return None
+        return key
+
+    def _xor(self, data: bytearray) -> bytearray:
+        for i in range(len(data)):
+            data[i] ^= self.XOR_KEY[i % len(self.XOR_KEY)]
+        return data
+
+    def overhead(self) -> int:
+        return 12 + 16 if self.aead else 0
+
+    def seal(self, data: bytes):
+        """Защищённое сообщение или None, если защиты нет и отправлять нельзя"""
+        if not self.aead:
+            return self._xor(bytearray(data)) if self.xor else None
+        with self.lock:
+            nonce = self.nonce_prefix + struct.pack('<I', self.counter & 0xFFFFFFFF)
+            self.counter += 1
+        return bytearray(nonce + self.aead.encrypt(nonce, bytes(data), None))
+
+    def open(self, message: bytes):
+        """Расшифрованные данные или None, если сообщение подделано или повреждено"""
+        if not self.aead:
+            return self._xor(bytearray(message)) if self.xor else None
+        if len(message) < self.overhead():
+            return None
+        from cryptography.exceptions import InvalidTag
+        try:
+            return bytearray(self.aead.decrypt(bytes(message[:12]), bytes(message[12:]), None))
+        except InvalidTag:
+            return None
+
+_payload_protection = None
+
+def payload_protection() -> PayloadProtection:
+    global _payload_protection
+    if _payload_protection is None:
+        _payload_protection = PayloadProtection()
+    return _payload_protection
+
 def image_tcp_listener(bind_addr: str, port: int):
     global _image_bytes, _image_mime, _image_ts
     server_sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
@@ -118,7 +218,12 @@ def image_tcp_listener(bind_addr: str, port: int):
         while conn != -1:
             tmp = bytearray()
 
-            count = int.from_bytes(recv_exact(conn, 4), 'little')
+            # ImageHeader (include/ImageFrame.h): size, sequence, timestampMs
+            header = recv_exact(conn, IMAGE_HEADER.size)
+            if len(header) != IMAGE_HEADER.size:
+                conn = -1
+                continue
+            count, sequence, timestamp_ms = IMAGE_HEADER.unpack(header)
             chunk = recv_exact(conn, count)
 
             if (count == -1) or (chunk == b""):
@@ -128,7 +233,14 @@ def image_tcp_listener(bind_addr: str, port: int):
             if (len(chunk) != count):
                 continue
 
-            tmp.extend(chunk)
+            protection = payload_protection()
+            opened = protection.open(chunk)
+            if opened is None:
+                if protection.enabled():
+                    print("Image TCP: authentication failed, frame dropped")
+                continue
+
+            tmp.extend(opened)
             if not tmp:
                 print("Image TCP: no data received from", addr)
                 if (tmp == b''):
@@ -165,7 +277,6 @@ class FlyPlaneData:
     def __init__(self):
         self.coords: List[WGS84Coord] = []
         self.point_count = 0
-        self.key = "uav"
     
     def set_coords(self, new_coords: List[WGS84Coord]):
         """Устанавливает новые координаты"""
@@ -180,68 +291,118 @@ class FlyPlaneData:
         """Возвращает количество точек"""
         return self.point_count
     
-    def xor_encrypt_decrypt(self, data: bytearray):
-        """Шифрует/дешифрует данные с помощью XOR"""
-        if not data or not self.key:
-            return
-        
-        key_bytes = self.key.encode('utf-8')
-        key_length = len(key_bytes)
-        
-        for i in range(len(data)):
-            data[i] ^= key_bytes[i % key_length]
-    
+    # Формат v1 (см. include/FlyPlaneData.h): заголовок 20 байт и точки int32 little-endian,
+    # широта/долгота в 1e-7 градуса, высота в миллиметрах
+    ROUTE_MAGIC = 0x52564155
+    ROUTE_VERSION = 1
+    ROUTE_HEADER = struct.Struct('<IBBHIII')
+    ROUTE_POINT = struct.Struct('<iii')
+    ROUTE_FLAG_DELTA_VARINT = 0x01  # первая точка целиком, далее zigzag-varint разности
+
+    @staticmethod
+    def _zigzag_varint(delta: int) -> bytes:
+        value = delta & 0xFFFFFFFF
+        value = ((value << 1) ^ (0xFFFFFFFF if value & 0x80000000 else 0)) & 0xFFFFFFFF
+        out = bytearray()
+        while value >= 0x80:
+            out.append((value & 0x7F) | 0x80)
+            value >>= 7
+        out.append(value)
+        return bytes(out)
+
+    @staticmethod
+    def _read_zigzag_varint(data: bytes, pos: int):
+        value, shift = 0, 0
+        while True:
+            byte = data[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            if not byte & 0x80:
+                break
+            shift += 7
+        return (value >> 1) ^ -(value & 1), pos
+
+    @staticmethod
+    def _to_int32(value: int) -> int:
+        value &= 0xFFFFFFFF
+        return value - (1 << 32) if value & 0x80000000 else value
+
     def get_serialized_size(self) -> int:
         """Возвращает размер сериализованных данных"""
-        # int (4 байта) + point_count * (3 float по 4 байта каждый)
-        return 4 + self.point_count * 12
+        return self.ROUTE_HEADER.size + self.point_count * self.ROUTE_POINT.size + payload_protection().overhead()
     
-    def serialization(self) -> bytearray:
-        """Сериализует данные в байтовый массив"""
-        total_size = self.get_serialized_size()
-        data = bytearray(total_size)
-        
-        # Сериализуем point_count
-        struct.pack_into('i', data, 0, self.point_count)
-        ptr = 4
-        
-        # Сериализуем координаты
-        for coord in self.coords:
-            struct.pack_into('fff', data, ptr, coord.lat, coord.lon, coord.alt)
-            ptr += 12
+    def serialization(self, compress: bool = True):
+        """Сериализует данные в байтовый массив, None - нет ключа защиты"""
+        points = [(round(c.lat * 1e7), round(c.lon * 1e7), round(c.alt * 1e3)) for c in self.coords]
+        flags = self.ROUTE_FLAG_DELTA_VARINT if compress else 0
+
+        payload = bytearray()
+        for i, point in enumerate(points):
+            if i == 0 or not compress:
+                payload += self.ROUTE_POINT.pack(*point)
+            else:
+                for current, previous in zip(point, points[i - 1]):
+                    payload += self._zigzag_varint(current - previous)
+
+        data = bytearray(self.ROUTE_HEADER.pack(self.ROUTE_MAGIC, self.ROUTE_VERSION, flags, self.ROUTE_HEADER.size,
+                                                self.point_count, len(payload), zlib.crc32(payload)))
+        data += payload
         
         # Шифруем данные
-        self.xor_encrypt_decrypt(data)
-        
-        return data
+        return payload_protection().seal(data)
     
     def deserialization(self, data: bytes) -> bool:
         """Десериализует данные из байтового массива"""
         if not data or len(data) < 4:
             return False
         
-        # Создаем временную копию для дешифровки
-        temp_data = bytearray(data)
-        self.xor_encrypt_decrypt(temp_data)
-        
-        # Десериализуем point_count
-        if len(temp_data) < 4:
+        # Проверяем подлинность и дешифруем копию
+        temp_data = payload_protection().open(data)
+        if temp_data is None or len(temp_data) < 4:
             return False
+
+        if len(temp_data) >= self.ROUTE_HEADER.size and struct.unpack_from('<I', temp_data, 0)[0] == self.ROUTE_MAGIC:
+            magic, version, flags, header_size, point_count, payload_size, crc = self.ROUTE_HEADER.unpack_from(temp_data, 0)
+            payload = bytes(temp_data[header_size:header_size + payload_size])
+            if len(payload) != payload_size or zlib.crc32(payload) != crc:
+                return False
+
+            if flags & self.ROUTE_FLAG_DELTA_VARINT:
+                points, pos = [], 0
+                try:
+                    for i in range(point_count):
+                        if i == 0:
+                            points.append(self.ROUTE_POINT.unpack_from(payload, 0))
+                            pos = self.ROUTE_POINT.size
+                            continue
+                        point = []
+                        for previous in points[-1]:
+                            delta, pos = self._read_zigzag_varint(payload, pos)
+                            point.append(self._to_int32(previous + delta))
+                        points.append(tuple(point))
+                except (IndexError, struct.error):
+                    return False
+            elif payload_size == point_count * self.ROUTE_POINT.size:
+                points = list(self.ROUTE_POINT.iter_unpack(payload))
+            else:
+                return False
+
+            self.coords = [WGS84Coord(lat * 1e-7, lon * 1e-7, alt * 1e-3) for lat, lon, alt in points]
+            self.point_count = point_count
+            return True
         
+        # Устаревший формат: int + float[3] на точку
         point_count = struct.unpack_from('i', temp_data, 0)[0]
         ptr = 4
         
         # Проверяем достаточно ли данных для координат
         required_size = 4 + point_count * 12
-        if len(temp_data) < required_size:
+        if point_count < 0 or len(temp_data) < required_size:
             return False
         
         # Десериализуем координаты
         self.coords = []
         for _ in range(point_count):
-            if ptr + 12 > len(temp_data):
-                return False
-            
             lat, lon, alt = struct.unpack_from('fff', temp_data, ptr)
             self.coords.append(WGS84Coord(lat, lon, alt))
             ptr += 12
@@ -297,6 +458,10 @@ class Handler(http.server.SimpleHTTPRequestHandler):
             plane_data = FlyPlaneData()
             plane_data.set_coords(coords)
             serialized = plane_data.serialization()
+            if serialized is None:
+                self.send_response(503); self.send_header("Content-Type","text/plain; charset=utf-8"); self.end_headers()
+                self.wfile.write(f"No payload key ({PAYLOAD_KEY_FILE}), route not sent".encode('utf-8'))
+                return
 
             res = send_serialized_data_tcp(COORD_TCP_BIND, DEFAULT_IMAGE_TCP_PORT + 1, serialized)
             if res == True:
@@ -0,0 +1,298 @@
+#include "ChaCha20Poly1305.h"
+#include "ChaCha20Kernel.h"
+
+#include <cstring>
+
+// 4 полосы по 32 бита: SSE2 на x86-64, NEON на AArch64
+typedef uint32_t u32x4 __attribute__((vector_size(16)));
+
+static inline uint32_t load32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline void store32(uint8_t* p, uint32_t v)
+{
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+#ifdef HAVE_AVX2_KERNELS
+static bool hasAVX2()
+{
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+void ChaCha20::init(const uint8_t key[CHACHA20_KEY_SIZE], const uint8_t nonce[CHACHA20_NONCE_SIZE], uint32_t counter)
+{
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    for (int i = 0; i < 8; ++i)
+        state[4 + i] = load32(key + 4 * i);
+    state[12] = counter;
+    for (int i = 0; i < 3; ++i)
+        state[13 + i] = load32(nonce + 4 * i);
+
+    used = sizeof(keystream);
+}
+
+void ChaCha20::xorBlocks(uint8_t* data, size_t blocks)
+{
+#ifdef HAVE_AVX2_KERNELS
+    if (hasAVX2())
+    {
+        for (; blocks >= 8; blocks -= 8, data += 8 * 64, state[12] += 8)
+            chacha20XorBlocks8(state, data);
+    }
+#endif
+
+    for (; blocks >= 4; blocks -= 4, data += 4 * 64, state[12] += 4)
+        chacha20XorBlocksV<u32x4>(state, data);
+}
+
+void ChaCha20::process(uint8_t* data, size_t size)
+{
+    // Остаток ключевого потока от прошлого вызова
+    while (size > 0 && used < sizeof(keystream))
+    {
+        *data++ ^= keystream[used++];
+        --size;
+    }
+
+    // Целые группы по 4 блока - напрямую в данных
+    size_t bulk = size / sizeof(keystream) * sizeof(keystream);
+    xorBlocks(data, bulk / 64);
+    data += bulk;
+    size -= bulk;
+
+    if (size > 0)
+    {
+        memset(keystream, 0, sizeof(keystream));
+        xorBlocks(keystream, sizeof(keystream) / 64);
+        used = 0;
+
+        while (size > 0)
+        {
+            *data++ ^= keystream[used++];
+            --size;
+        }
+    }
+}
+
+void Poly1305::init(const uint8_t key[32])
+{
+    r[0] = (load32(key + 0)) & 0x3ffffff;
+    r[1] = (load32(key + 3) >> 2) & 0x3ffff03;
+    r[2] = (load32(key + 6) >> 4) & 0x3ffc0ff;
+    r[3] = (load32(key + 9) >> 6) & 0x3f03fff;
+    r[4] = (load32(key + 12) >> 8) & 0x00fffff;
+
+    for (int i = 0; i < 5; ++i)
+        h[i] = 0;
+    for (int i = 0; i < 4; ++i)
+        pad[i] = load32(key + 16 + 4 * i);
+
+    buffered = 0;
+}
+
+void Poly1305::blocks(const uint8_t* m, size_t size, uint32_t hibit)
+{
+    const uint32_t r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+    const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    uint32_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4];
+
+    for (; size >= 16; size -= 16, m += 16)
+    {
+        h0 += (load32(m + 0)) & 0x3ffffff;
+        h1 += (load32(m + 3) >> 2) & 0x3ffffff;
+        h2 += (load32(m + 6) >> 4) & 0x3ffffff;
+        h3 += (load32(m + 9) >> 6) & 0x3ffffff;
+        h4 += (load32(m + 12) >> 8) | hibit;
+
+        uint64_t d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 + (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+        uint64_t d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4 + (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+        uint64_t d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0 + (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+        uint64_t d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1 + (uint64_t)h3 * r0 + (uint64_t)h4 * s4;
+        uint64_t d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2 + (uint64_t)h3 * r1 + (uint64_t)h4 * r0;
+
+        uint32_t c;
+        c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & 0x3ffffff;
+        d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & 0x3ffffff;
+        d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & 0x3ffffff;
+        d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & 0x3ffffff;
+        d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & 0x3ffffff;
+        h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+        h1 += c;
+    }
+
+    h[0] = h0; h[1] = h1; h[2] = h2; h[3] = h3; h[4] = h4;
+}
+
+void Poly1305::update(const uint8_t* data, size_t size)
+{
+    if (buffered > 0)
+    {
+        size_t take = 16 - buffered < size ? 16 - buffered : size;
+        memcpy(buffer + buffered, data, take);
+        buffered += take;
+        data += take;
+        size -= take;
+
+        if (buffered < 16) return;
+        blocks(buffer, 16, 1u << 24);
+        buffered = 0;
+    }
+
+    size_t bulk = size & ~static_cast<size_t>(15);
+    blocks(data, bulk, 1u << 24);
+    data += bulk;
+    size -= bulk;
+
+    memcpy(buffer, data, size);
+    buffered = size;
+}
+
+void Poly1305::finish(uint8_t tag[POLY1305_TAG_SIZE])
+{
+    if (buffered > 0)
+    {
+        buffer[buffered++] = 1;
+        memset(buffer + buffered, 0, 16 - buffered);
+        blocks(buffer, 16, 0);
+        buffered = 0;
+    }
+
+    uint32_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3], h4 = h[4], c;
+
+    c = h1 >> 26; h1 &= 0x3ffffff;
+    h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+    h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+    h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+    h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+    h1 += c;
+
+    // g = h - p; берём g, если h >= p
+    uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+    uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+    uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+    uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+    uint32_t g4 = h4 + c - (1u << 26);
+
+    uint32_t mask = (g4 >> 31) - 1;
+    g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+    mask = ~mask;
+    h0 = (h0 & mask) | g0;
+    h1 = (h1 & mask) | g1;
+    h2 = (h2 & mask) | g2;
+    h3 = (h3 & mask) | g3;
+    h4 = (h4 & mask) | g4;
+
+    h0 = h0 | (h1 << 26);
+    h1 = (h1 >> 6) | (h2 << 20);
+    h2 = (h2 >> 12) | (h3 << 14);
+    h3 = (h3 >> 18) | (h4 << 8);
+
+    uint64_t f;
+    f = (uint64_t)h0 + pad[0]; h0 = (uint32_t)f;
+    f = (uint64_t)h1 + pad[1] + (f >> 32); h1 = (uint32_t)f;
+    f = (uint64_t)h2 + pad[2] + (f >> 32); h2 = (uint32_t)f;
+    f = (uint64_t)h3 + pad[3] + (f >> 32); h3 = (uint32_t)f;
+
+    store32(tag + 0, h0);
+    store32(tag + 4, h1);
+    store32(tag + 8, h2);
+    store32(tag + 12, h3);
+
+    // Ключ одноразовый, не оставляем его в памяти
+    memset(r, 0, sizeof(r));
+    memset(pad, 0, sizeof(pad));
+}
+
+void ChaCha20Poly1305::init(const uint8_t key[CHACHA20_KEY_SIZE], const uint8_t nonce[CHACHA20_NONCE_SIZE])
+{
+    // Ключ Poly1305 - первые 32 байта блока 0, данные шифруются с блока 1
+    uint8_t polyKey[64] = {0};
+    cipher.init(key, nonce, 0);
+    cipher.process(polyKey, sizeof(polyKey));
+    mac.init(polyKey);
+    memset(polyKey, 0, sizeof(polyKey));
+
+    cipher.init(key, nonce, 1);
+    aadSize = 0;
+    textSize = 0;
+    aadPadded = false;
+}
+
+void ChaCha20Poly1305::padMac(uint64_t size)
+{
+    static const uint8_t zeros[16] = {0};
+    if (size % 16) mac.update(zeros, 16 - size % 16);
+}
+
+void ChaCha20Poly1305::finishAad()
+{
+    if (aadPadded) return;
+    padMac(aadSize);
+    aadPadded = true;
+}
+
+void ChaCha20Poly1305::aad(const uint8_t* data, size_t size)
+{
+    mac.update(data, size);
+    aadSize += size;
+}
+
+void ChaCha20Poly1305::encrypt(uint8_t* data, size_t size)
+{
+    finishAad();
+    cipher.process(data, size);
+    mac.update(data, size);
+    textSize += size;
+}
+
+void ChaCha20Poly1305::decrypt(uint8_t* data, size_t size)
+{
+    authenticate(data, size);
+    cipher.process(data, size);
+}
+
+void ChaCha20Poly1305::authenticate(const uint8_t* data, size_t size)
+{
+    finishAad();
+    mac.update(data, size);
+    textSize += size;
+}
+
+void ChaCha20Poly1305::finish(uint8_t tag[POLY1305_TAG_SIZE])
+{
+    finishAad();
+    padMac(textSize);
+
+    uint8_t sizes[16];
+    for (int i = 0; i < 8; ++i)
+    {
+        sizes[i] = static_cast<uint8_t>(aadSize >> (8 * i));
+        sizes[8 + i] = static_cast<uint8_t>(textSize >> (8 * i));
+    }
+    mac.update(sizes, sizeof(sizes));
+    mac.finish(tag);
+}
+
+bool ChaCha20Poly1305::verify(const uint8_t tag[POLY1305_TAG_SIZE])
+{
+    uint8_t expected[POLY1305_TAG_SIZE];
+    finish(expected);
+
+    uint8_t diff = 0;
+    for (int i = 0; i < POLY1305_TAG_SIZE; ++i)
+        diff |= expected[i] ^ tag[i];
+
+    return diff == 0;
+}
@@ -0,0 +1,9 @@
+#include "ChaCha20Kernel.h"
+
+// Файл собирается с -mavx2, вызывается только если процессор поддерживает AVX2
+typedef uint32_t u32x8 __attribute__((vector_size(32)));
+
+void chacha20XorBlocks8(const uint32_t input[16], uint8_t* data)
+{
+    chacha20XorBlocksV<u32x8>(input, data);
+}
@@ -1,121 +1,172 @@
 #include "FlyPlaneData.h"
+#include "WireFormat.h"
+#include "RouteCodec.h"
+#include "RouteStreamDecoder.h"
+#include "PayloadProtection.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <stdexcept>
 #include <vector>
 #include <fstream>
 
 WGS84Coord::WGS84Coord() : lat(0), lon(0), alt(0) {}
-WGS84Coord::WGS84Coord(float lat, float lon, float alt) : lat(lat), lon(lon), alt(alt) {}
+WGS84Coord::WGS84Coord(double lat, double lon, double alt) : lat(lat), lon(lon), alt(alt) {}
 
-FlyPlaneData::FlyPlaneData()
+WGS84CoordInt WGS84CoordInt::fromCoord(const WGS84Coord& coord)
 {
-    coords = nullptr;
-    pointCount = 0;
+    WGS84CoordInt point;
+    point.lat = static_cast<int32_t>(std::lround(coord.lat * 1e7));
+    point.lon = static_cast<int32_t>(std::lround(coord.lon * 1e7));
+    point.alt = static_cast<int32_t>(std::lround(coord.alt * 1e3));
+    return point;
 }
 
-FlyPlaneData::~FlyPlaneData() 
+WGS84Coord WGS84CoordInt::toCoord() const
 {
-    delete[] coords;
-    coords = nullptr;
+    return WGS84Coord(lat * 1e-7, lon * 1e-7, alt * 1e-3);
+}
+
+bool WGS84CoordInt::operator==(const WGS84CoordInt& other) const
+{
+    return lat == other.lat && lon == other.lon && alt == other.alt;
+}
+
+bool WGS84CoordInt::operator!=(const WGS84CoordInt& other) const
+{
+    return !(*this == other);
+}
+
+void encodeRouteHeader(const RouteHeader& header, unsigned char* data)
+{
+    wireEncode(header, data);
+}
+
+bool decodeRouteHeader(const unsigned char* data, size_t size, RouteHeader& header)
+{
+    if (!data || size < wireSize<RouteHeader>()) return false;
+
+    wireDecode(header, data);
+
+    // Более новые версии могут удлинять заголовок, но не укорачивать
+    return header.magic == ROUTE_MAGIC && header.version >= 1 &&
+           header.headerSize >= ROUTE_HEADER_SIZE && header.headerSize <= size;
+}
+
+void encodeRoutePoint(const WGS84CoordInt& point, unsigned char* data)
+{
+    wireEncode(point, data);
+}
+
+WGS84CoordInt decodeRoutePoint(const unsigned char* data)
+{
+    WGS84CoordInt point;
+    wireDecode(point, data);
+    return point;
 }
 
 void FlyPlaneData::setCoords(WGS84Coord* newCoords, int count) 
 {
-    delete[] coords;
-    
-    coords = new WGS84Coord[count];
-    pointCount = count;
+    points.clear();
+    points.reserve(count);
     
     for (int i = 0; i < count; ++i) {
-        coords[i] = newCoords[i];
+        points.push_back(WGS84CoordInt::fromCoord(newCoords[i]));
     }
 }
 
-WGS84Coord* FlyPlaneData::getCoords() const 
+void FlyPlaneData::setPoints(const WGS84CoordInt* newPoints, int count)
+{
+    points.assign(newPoints, newPoints + count);
+}
+
+void FlyPlaneData::setPoints(std::vector<WGS84CoordInt>&& newPoints)
+{
+    points = std::move(newPoints);
+}
+
+const WGS84CoordInt* FlyPlaneData::getPoints() const 
 { 
-    return coords; 
+    return points.data(); 
 }
 
 int FlyPlaneData::getPointCount() const 
 { 
-    return pointCount; 
+    return static_cast<int>(points.size()); 
 }
 
-void FlyPlaneData::xorEncryptDecrypt(unsigned char* data, size_t size) 
+void FlyPlaneData::reserve(size_t count)
 {
-    if (!data || size == 0) return;
+    points.reserve(count);
+}
 
-    size_t keyLength = strlen(key);
+void FlyPlaneData::append(const WGS84CoordInt& point)
+{
+    points.push_back(point);
+}
 
-    for (size_t i = 0; i < size; i++)
-        data[i] ^= key[i % keyLength];
+void FlyPlaneData::clear()
+{
+    points.clear();
+    encodingFlags = 0;
+}
+
+void FlyPlaneData::setEncodingFlags(uint8_t flags)
+{
+    encodingFlags = flags;
+}
+
+uint8_t FlyPlaneData::getEncodingFlags() const
+{
+    return encodingFlags;
 }
 
 unsigned char* FlyPlaneData::Serialization() {
-    size_t totalSize = getSerializedSize();
-    unsigned char* data = new unsigned char[totalSize];
-    unsigned char* ptr = data;
-
-    // Сериализуем pointCount
-    memcpy(ptr, &pointCount, sizeof(int));
-    ptr += sizeof(int);
-
-    // Сериализуем coords
-    if (coords && pointCount > 0) {
-        memcpy(ptr, coords, sizeof(WGS84Coord) * pointCount);
-        ptr += sizeof(WGS84Coord) * pointCount;
-    }
+    PayloadProtector& protector = payloadProtector();
+    size_t frameSize = ROUTE_HEADER_SIZE + routePayloadSize(points.data(), getPointCount(), encodingFlags);
+    unsigned char* message = new unsigned char[frameSize + protector.overhead()];
+    unsigned char* data = message + protector.prefixSize();
+    unsigned char* payload = data + ROUTE_HEADER_SIZE;
+
+    // Сериализуем координаты
+    encodeRoutePayload(points.data(), getPointCount(), encodingFlags, payload);
+
+    // Заголовок с контрольной суммой полезной нагрузки
+    RouteHeader header;
+    header.flags = encodingFlags;
+    header.pointCount = static_cast<uint32_t>(points.size());
+    header.payloadSize = static_cast<uint32_t>(frameSize - ROUTE_HEADER_SIZE);
+    header.crc = crc32(payload, header.payloadSize);
+    encodeRouteHeader(header, data);
 
     // Шифруем данные
-    xorEncryptDecrypt(data, totalSize);
+    protector.seal(message, frameSize);
 
-    return data;
+    return message;
 }
 
 bool FlyPlaneData::DeSerialization(unsigned char* ptr, size_t data_size) {
-    if (!ptr || data_size < sizeof(int) + sizeof(size_t)) {
+    if (!ptr || data_size < sizeof(int32_t)) {
         return false;
     }
 
-    // Создаем временную копию для дешифровки
-    unsigned char* temp_data = new unsigned char[data_size];
-    memcpy(temp_data, ptr, data_size);
-    xorEncryptDecrypt(temp_data, data_size);
+    // Расшифровка идёт по частям через небольшой буфер, входные данные не меняются
+    RouteStreamDecoder decoder(*this);
+    unsigned char chunk[4096];
 
-    unsigned char* temp_ptr = temp_data;
-    size_t remaining_size = data_size;
-
-    // Десериализуем pointCount
-    if (remaining_size < sizeof(int)) {
-        delete[] temp_data;
-        return false;
-    }
-    memcpy(&pointCount, temp_ptr, sizeof(int));
-    temp_ptr += sizeof(int);
-    remaining_size -= sizeof(int);
-
-    // Десериализуем coords
-    delete[] coords;
-    coords = nullptr;
-    
-    if (pointCount > 0) {
-        size_t coords_size = sizeof(WGS84Coord) * pointCount;
-        if (remaining_size < coords_size) {
-            delete[] temp_data;
-            return false;
-        }
-        coords = new WGS84Coord[pointCount];
-        memcpy(coords, temp_ptr, coords_size);
-        temp_ptr += coords_size;
-        remaining_size -= coords_size;
+    for (size_t offset = 0; offset < data_size && !decoder.done(); )
+    {
+        size_t n = std::min(sizeof(chunk), data_size - offset);
+        memcpy(chunk, ptr + offset, n);
+        if (decoder.feed(chunk, n) < 0) return false;
+        offset += n;
     }
 
-    delete[] temp_data;
-    return true;
+    return decoder.done();
 }
 
 size_t FlyPlaneData::getSerializedSize() const {
-    size_t totalSize = sizeof(int); // pointCount
-    totalSize += sizeof(WGS84Coord) * pointCount;
-    return totalSize;
+    size_t totalSize = ROUTE_HEADER_SIZE;
+    totalSize += routePayloadSize(points.data(), getPointCount(), encodingFlags);
+    return totalSize + payloadProtector().overhead();
 }
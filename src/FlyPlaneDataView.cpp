@@ -0,0 +1,128 @@
+#include "FlyPlaneDataView.h"
+#include "WireFormat.h"
+
+#include <cstring>
+#include <vector>
+
+bool FlyPlaneDataView::parsePlain(const unsigned char* data, size_t size)
+{
+    *this = FlyPlaneDataView();
+    if (!data || size < sizeof(int32_t)) return false;
+
+    RouteHeader header;
+    if (!decodeRouteHeader(data, size, header))
+    {
+        int32_t count;
+        memcpy(&count, data, sizeof(count));
+        if (count < 0 || (size - sizeof(int32_t)) / (3 * sizeof(float)) < static_cast<size_t>(count))
+            return false;
+
+        payload = data + sizeof(int32_t);
+        payloadSize = static_cast<size_t>(count) * 3 * sizeof(float);
+        pointCount = static_cast<uint32_t>(count);
+        legacy = true;
+        return true;
+    }
+
+    if (header.payloadSize > size - header.headerSize || !checkRouteHeader(header))
+        return false;
+
+    const unsigned char* body = data + header.headerSize;
+    if (crc32(body, header.payloadSize) != header.crc)
+        return false;
+
+    payload = body;
+    payloadSize = header.payloadSize;
+    pointCount = header.pointCount;
+    encodingFlags = header.flags;
+    return true;
+}
+
+uint32_t FlyPlaneDataView::getPointCount() const
+{
+    return pointCount;
+}
+
+uint8_t FlyPlaneDataView::getEncodingFlags() const
+{
+    return encodingFlags;
+}
+
+bool FlyPlaneDataView::isLegacy() const
+{
+    return legacy;
+}
+
+bool FlyPlaneDataView::at(uint32_t index, WGS84CoordInt& point) const
+{
+    if (index >= pointCount) return false;
+
+    if (legacy)
+    {
+        float values[3];
+        memcpy(values, payload + static_cast<size_t>(index) * sizeof(values), sizeof(values));
+        point = WGS84CoordInt::fromCoord(WGS84Coord(values[0], values[1], values[2]));
+        return true;
+    }
+
+    if (!(encodingFlags & ROUTE_FLAG_DELTA_VARINT))
+    {
+        point = decodeRoutePoint(payload + static_cast<size_t>(index) * ROUTE_POINT_SIZE);
+        return true;
+    }
+
+    // Назад по разностям не пройти - начинаем с первой точки
+    if (cursor.position() == 0 || index + 1 < cursor.position())
+        cursor = RoutePointReader(payload, payloadSize, pointCount, encodingFlags);
+
+    while (cursor.position() < index + 1)
+        if (!cursor.next(cursorPoint)) return false;
+
+    point = cursorPoint;
+    return true;
+}
+
+FlyPlaneDataView::Iterator::Iterator(const FlyPlaneDataView* view, uint32_t index)
+    : view(view), index(index), reader(view->payload, view->payloadSize, view->pointCount, view->encodingFlags)
+{
+    load();
+}
+
+void FlyPlaneDataView::Iterator::load()
+{
+    if (index >= view->pointCount) return;
+
+    bool ok = (view->encodingFlags & ROUTE_FLAG_DELTA_VARINT) && !view->legacy
+                  ? reader.next(point)
+                  : view->at(index, point);
+
+    // Повреждённые данные обрывают обход
+    if (!ok) index = view->pointCount;
+}
+
+FlyPlaneDataView::Iterator& FlyPlaneDataView::Iterator::operator++()
+{
+    ++index;
+    load();
+    return *this;
+}
+
+FlyPlaneDataView::Iterator FlyPlaneDataView::begin() const
+{
+    return Iterator(this, 0);
+}
+
+FlyPlaneDataView::Iterator FlyPlaneDataView::end() const
+{
+    return Iterator(this, pointCount);
+}
+
+void FlyPlaneDataView::copyTo(FlyPlaneData& data) const
+{
+    data.clear();
+    data.reserve(pointCount);
+    for (const WGS84CoordInt& point : *this)
+        data.append(point);
+
+    data.setEncodingFlags(encodingFlags);
+}
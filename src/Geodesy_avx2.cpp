@@ -0,0 +1,23 @@
+#include <immintrin.h>
+
+#include "GeodesyKernel.h"
+
+// Файл собирается с -mavx2, вызывается только если процессор поддерживает AVX2
+typedef double f64x4 __attribute__((vector_size(32)));
+
+template <>
+inline f64x4 geoSqrt<f64x4>(f64x4 x)
+{
+    return _mm256_sqrt_pd(x);
+}
+
+void geodesyPoints4(const double* lat, double* sinLat, double* cosLat)
+{
+    geodesyPointsV<f64x4>(lat, sinLat, cosLat);
+}
+
+void geodesyLegs4(const double* lat, const double* lon, const double* sinLat, const double* cosLat,
+                  double* distance, double* bearing)
+{
+    geodesyLegsV<f64x4>(lat, lon, sinLat, cosLat, distance, bearing);
+}
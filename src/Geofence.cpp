@@ -0,0 +1,250 @@
+#include "Geofence.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+bool Geofence::Box::intersects(const Box& other) const
+{
+    return minLat <= other.maxLat && other.minLat <= maxLat &&
+           minLon <= other.maxLon && other.minLon <= maxLon;
+}
+
+void Geofence::Box::expand(const Box& other)
+{
+    minLat = std::min(minLat, other.minLat);
+    minLon = std::min(minLon, other.minLon);
+    maxLat = std::max(maxLat, other.maxLat);
+    maxLon = std::max(maxLon, other.maxLon);
+}
+
+bool Geofence::addPolygon(const std::vector<WGS84Coord>& vertices)
+{
+    if (vertices.size() < 3) return false;
+
+    Polygon polygon;
+    polygon.id = static_cast<int>(polygons.size());
+    polygon.box = { vertices[0].lat, vertices[0].lon, vertices[0].lat, vertices[0].lon };
+    for (const WGS84Coord& vertex : vertices)
+    {
+        polygon.lat.push_back(vertex.lat);
+        polygon.lon.push_back(vertex.lon);
+        polygon.box.expand({ vertex.lat, vertex.lon, vertex.lat, vertex.lon });
+    }
+
+    polygons.push_back(std::move(polygon));
+    built = false;
+    return true;
+}
+
+bool Geofence::loadFile(const char* path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Geofence: no zone file " << path << ", routes are not checked against zones" << std::endl;
+        return false;
+    }
+
+    int count;
+    while (file >> count)
+    {
+        std::vector<WGS84Coord> vertices(count > 0 ? count : 0);
+        for (WGS84Coord& vertex : vertices)
+            file >> vertex.lat >> vertex.lon;
+
+        if (!file || !addPolygon(vertices)) {
+            std::cerr << "Geofence: bad polygon " << polygons.size() << " in " << path
+                      << ", all routes will be rejected" << std::endl;
+            broken = true;
+            return false;
+        }
+    }
+
+    build();
+    return true;
+}
+
+void Geofence::build()
+{
+    nodes.clear();
+    built = true;
+    if (polygons.empty()) return;
+
+    // Листья: полигоны, упорядоченные по STR, чтобы соседние в массиве были рядом на карте
+    std::vector<uint32_t> order(polygons.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+
+    std::vector<Box> boxes;
+    for (const Polygon& polygon : polygons) boxes.push_back(polygon.box);
+
+    // Один уровень STR: сортировка по долготе центров, нарезка на вертикальные полосы,
+    // внутри полосы - по широте, затем группы по NODE_CAPACITY
+    auto pack = [](std::vector<uint32_t>& items, const std::vector<Box>& itemBoxes) {
+        size_t groups = (items.size() + NODE_CAPACITY - 1) / NODE_CAPACITY;
+        size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(groups))));
+        size_t perSlice = slices * NODE_CAPACITY;
+
+        auto centerLon = [&](uint32_t i) { return itemBoxes[i].minLon + itemBoxes[i].maxLon; };
+        auto centerLat = [&](uint32_t i) { return itemBoxes[i].minLat + itemBoxes[i].maxLat; };
+
+        std::sort(items.begin(), items.end(), [&](uint32_t a, uint32_t b) { return centerLon(a) < centerLon(b); });
+        for (size_t start = 0; start < items.size(); start += perSlice)
+        {
+            auto end = items.begin() + std::min(items.size(), start + perSlice);
+            std::sort(items.begin() + start, end, [&](uint32_t a, uint32_t b) { return centerLat(a) < centerLat(b); });
+        }
+    };
+
+    pack(order, boxes);
+
+    std::vector<Polygon> sorted;
+    sorted.reserve(polygons.size());
+    for (uint32_t i : order) sorted.push_back(std::move(polygons[i]));
+    polygons.swap(sorted);
+
+    for (uint32_t first = 0; first < polygons.size(); first += NODE_CAPACITY)
+    {
+        Node node;
+        node.first = first;
+        node.count = std::min<uint32_t>(NODE_CAPACITY, polygons.size() - first);
+        node.leaf = true;
+        node.box = polygons[first].box;
+        for (uint32_t i = first + 1; i < first + node.count; ++i) node.box.expand(polygons[i].box);
+        nodes.push_back(node);
+    }
+
+    // Верхние уровни: узлы уровня упаковываются так же и переставляются на место
+    size_t levelStart = 0;
+    while (nodes.size() - levelStart > 1)
+    {
+        size_t levelEnd = nodes.size();
+        std::vector<uint32_t> items;
+        std::vector<Box> itemBoxes;
+        for (size_t i = levelStart; i < levelEnd; ++i) {
+            items.push_back(static_cast<uint32_t>(items.size()));
+            itemBoxes.push_back(nodes[i].box);
+        }
+
+        pack(items, itemBoxes);
+
+        std::vector<Node> level;
+        for (uint32_t i : items) level.push_back(nodes[levelStart + i]);
+        std::copy(level.begin(), level.end(), nodes.begin() + levelStart);
+
+        for (size_t first = levelStart; first < levelEnd; first += NODE_CAPACITY)
+        {
+            Node parent;
+            parent.first = static_cast<uint32_t>(first);
+            parent.count = static_cast<uint32_t>(std::min<size_t>(NODE_CAPACITY, levelEnd - first));
+            parent.leaf = false;
+            parent.box = nodes[first].box;
+            for (size_t i = first + 1; i < first + parent.count; ++i) parent.box.expand(nodes[i].box);
+            nodes.push_back(parent);
+        }
+
+        levelStart = levelEnd;
+    }
+}
+
+size_t Geofence::size() const
+{
+    return polygons.size();
+}
+
+bool Geofence::segmentsIntersect(double aLat, double aLon, double bLat, double bLon,
+                                 double cLat, double cLon, double dLat, double dLon)
+{
+    auto cross = [](double oLat, double oLon, double pLat, double pLon, double qLat, double qLon) {
+        double value = (pLon - oLon) * (qLat - oLat) - (pLat - oLat) * (qLon - oLon);
+        return (value > 0) - (value < 0);
+    };
+    auto within = [](double o, double p, double q) { return std::min(o, p) <= q && q <= std::max(o, p); };
+
+    int d1 = cross(cLat, cLon, dLat, dLon, aLat, aLon);
+    int d2 = cross(cLat, cLon, dLat, dLon, bLat, bLon);
+    int d3 = cross(aLat, aLon, bLat, bLon, cLat, cLon);
+    int d4 = cross(aLat, aLon, bLat, bLon, dLat, dLon);
+
+    if (d1 * d2 < 0 && d3 * d4 < 0) return true;
+
+    // Касание и наложение на одной прямой тоже считаются пересечением
+    return (d1 == 0 && within(cLat, dLat, aLat) && within(cLon, dLon, aLon)) ||
+           (d2 == 0 && within(cLat, dLat, bLat) && within(cLon, dLon, bLon)) ||
+           (d3 == 0 && within(aLat, bLat, cLat) && within(aLon, bLon, cLon)) ||
+           (d4 == 0 && within(aLat, bLat, dLat) && within(aLon, bLon, dLon));
+}
+
+bool Geofence::contains(const Polygon& polygon, double lat, double lon) const
+{
+    // Чётность пересечений луча вдоль долготы
+    bool inside = false;
+    size_t count = polygon.lat.size();
+    for (size_t i = 0, j = count - 1; i < count; j = i++)
+    {
+        if ((polygon.lat[i] > lat) != (polygon.lat[j] > lat) &&
+            lon < (polygon.lon[j] - polygon.lon[i]) * (lat - polygon.lat[i]) / (polygon.lat[j] - polygon.lat[i]) + polygon.lon[i])
+            inside = !inside;
+    }
+    return inside;
+}
+
+bool Geofence::touches(const Polygon& polygon, double aLat, double aLon, double bLat, double bLon) const
+{
+    // Участок целиком внутри зоны не пересекает рёбер - проверяем его начало
+    if (contains(polygon, aLat, aLon)) return true;
+
+    size_t count = polygon.lat.size();
+    for (size_t i = 0, j = count - 1; i < count; j = i++)
+        if (segmentsIntersect(aLat, aLon, bLat, bLon, polygon.lat[j], polygon.lon[j], polygon.lat[i], polygon.lon[i]))
+            return true;
+
+    return false;
+}
+
+std::vector<GeofenceViolation> Geofence::check(const WGS84CoordInt* points, int count) const
+{
+    std::vector<GeofenceViolation> violations;
+
+    // Зоны заданы, но не проверены: маршрут не пропускается
+    if (broken || (!built && !polygons.empty()))
+    {
+        std::cerr << "Geofence: zones are not loaded or indexed" << std::endl;
+        violations.push_back({ -1, GEOFENCE_INVALID });
+        return violations;
+    }
+    if (nodes.empty() || count <= 0) return violations;
+
+    std::vector<uint32_t> stack;
+    int legs = count > 1 ? count - 1 : 1;
+
+    for (int leg = 0; leg < legs; ++leg)
+    {
+        WGS84Coord a = points[leg].toCoord();
+        WGS84Coord b = points[count > 1 ? leg + 1 : leg].toCoord();
+        Box box = { std::min(a.lat, b.lat), std::min(a.lon, b.lon), std::max(a.lat, b.lat), std::max(a.lon, b.lon) };
+
+        stack.assign(1, static_cast<uint32_t>(nodes.size() - 1));
+        while (!stack.empty())
+        {
+            const Node& node = nodes[stack.back()];
+            stack.pop_back();
+            if (!node.box.intersects(box)) continue;
+
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                if (!node.leaf)
+                    stack.push_back(i);
+                else if (polygons[i].box.intersects(box) && touches(polygons[i], a.lat, a.lon, b.lat, b.lon))
+                    violations.push_back({ leg, polygons[i].id });
+            }
+        }
+    }
+
+    return violations;
+}
+
+std::vector<GeofenceViolation> Geofence::check(const FlyPlaneData& route) const
+{
+    return check(route.getPoints(), route.getPointCount());
+}
@@ -1,5 +1,15 @@
 #include "InterfaceTCP.h"
 
+#include <fcntl.h>
+#include <poll.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
 InterfaceTCPServer::InterfaceTCPServer(const char *ip, const int port)
 {
     // Создание сокета
@@ -43,6 +53,25 @@ int InterfaceTCPServer::recvData(uint8_t buffer[])
         return -1;
 }
 
+int InterfaceTCPServer::recvExact(uint8_t* buffer, size_t size)
+{
+    if (!ConnectToClient()) return -1;
+
+    size_t received = 0;
+    while (received < size)
+    {
+        ssize_t n = recv(client_fd, buffer + received, size - received, 0);
+        if (n <= 0) {
+            close(client_fd);
+            client_fd = -1;
+            return -1;
+        }
+        received += n;
+    }
+
+    return static_cast<int>(received);
+}
+
 bool InterfaceTCPServer::ConnectToClient()
 {
     if (client_fd <= 0) 
@@ -63,129 +92,305 @@ int InterfaceTCPServer::readFlyPlaneData(FlyPlaneData &data)
 {
     if (!ConnectToClient()) return -1;
 
-    unsigned char* buffer = new unsigned char [BUFFER_SIZE];
-    ssize_t bytesReceived = recv(client_fd, buffer, BUFFER_SIZE, 0);
-    
-    if (bytesReceived > 0) 
-    {
-        unsigned char* received_data = new unsigned char[bytesReceived];
-        memcpy(received_data, buffer, bytesReceived);
+    RouteStreamDecoder decoder(data);
+    std::vector<unsigned char> chunk(ROUTE_CHUNK_SIZE);
+    size_t received = 0;
 
-        data.DeSerialization(received_data, bytesReceived);
-        
-        delete[] received_data;
-        
-        close(client_fd);
-        client_fd = -1;
-    }
-    else if (bytesReceived < 0)
+    while (!decoder.done())
     {
-        close(client_fd);
-        client_fd = -1;
+        ssize_t n = recv(client_fd, chunk.data(), chunk.size(), 0);
+        if (n <= 0 || decoder.feed(chunk.data(), n) < 0) break;
+        received += n;
     }
 
-    delete[] buffer;
+    close(client_fd);
+    client_fd = -1;
+
+    if (!decoder.done())
+    {
+        data.clear();
+        return received > 0 ? -1 : 0;
+    }
 
-    return bytesReceived;
+    return static_cast<int>(decoder.messageSize());
 }
 
 InterfaceTCPClient::InterfaceTCPClient(const char *ip, const int port)
 {
     IP = ip;
     PORT = port;
+
+    serv_addr.sin_family = AF_INET;
+    serv_addr.sin_port = htons(PORT);
+    if (inet_pton(AF_INET, IP, &serv_addr.sin_addr) <= 0)
+        perror("Invalid address/ Address not supported");
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    manager = std::thread(&InterfaceTCPClient::managerLoop, this);
 }
 
 InterfaceTCPClient::~InterfaceTCPClient()
 {
-    if (sock > 0) close(sock);
+    running = false;
+
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0) perror("wake");
+
+    if (manager.joinable()) manager.join();
+
+    disconnect();
+    if (wakeFd != -1) close(wakeFd);
+}
+
+TCPState InterfaceTCPClient::getState() const
+{
+    return state;
+}
+
+bool InterfaceTCPClient::isConnected() const
+{
+    return state == TCPState::Connected;
 }
 
-int InterfaceTCPClient::sendData(unsigned char *data, size_t dataSize)
+bool InterfaceTCPClient::waitConnected(std::chrono::milliseconds timeout)
 {
-    for (int i = 0; i < 10; ++i)
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (!isConnected())
     {
-        if (sock > 0)
-            break;
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
 
-        if (sock <= 0)
-            ConnectToServer();
-        else
-            usleep(1*100*1000);
+    return true;
+}
+
+int InterfaceTCPClient::sendData(unsigned char *data, size_t dataSize, bool dropIfFull)
+{
+    if (!isConnected()) return -1;
+
+    std::lock_guard<std::mutex> writer(writeMutex);
+
+    // Сокет берётся под блокировкой, отправка идёт без неё: disconnect и переподключение
+    // не ждут медленный send
+    int fd;
+    {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        if (sock < 0) return -1;
+        fd = sock;
+        sending = true;
     }
-    
-    if (sock > 0) 
+
+    // Предыдущее сообщение ещё не ушло из сокета - канал не успевает, новое отбрасывается
+    // целиком до первого байта, поток данных не нарушается
+    int unsent = 0;
+    bool drop = dropIfFull && ioctl(fd, SIOCOUTQNSD, &unsent) == 0 && unsent > 0;
+
+    // send может отправить часть данных, досылаем остаток
+    size_t sent = 0;
+    bool failed = false;
+    while (!drop && sent < dataSize)
     {
-        auto result = send(sock, data, dataSize, MSG_NOSIGNAL);
-        if (result == -1)
+        ssize_t result = send(fd, data + sent, dataSize - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (result < 0 && errno == EINTR) continue;
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
         {
-            close(sock);
-            sock = -1;
+            if (sent == 0 && dropIfFull)
+            {
+                drop = true;
+                break;
+            }
+
+            pollfd out = {fd, POLLOUT, 0};
+            int r;
+            do {
+                r = poll(&out, 1, TCP_USER_TIMEOUT_MS);
+            } while (r < 0 && errno == EINTR);
+            if (r > 0 && !(out.revents & (POLLERR | POLLHUP | POLLNVAL))) continue;
         }
+        else if (result > 0)
+        {
+            sent += result;
+            continue;
+        }
+
+        failed = true;
+        break;
+    }
+
+    std::lock_guard<std::mutex> lock(sendMutex);
+    sending = false;
+    if (sock != fd)
+    {
+        // Соединение закрыли во время отправки (disconnect только прервал её)
+        close(fd);
+        return -1;
     }
+    if (failed)
+    {
+        close(sock);
+        sock = -1;
+        state = TCPState::Disconnected;
+
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0) perror("wake");
+        return -1;
+    }
+
+    return static_cast<int>(sent);
 }
 
 bool InterfaceTCPClient::ConnectToServer()
 {
     // Создание сокета
-    if ((sock = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
         perror("Socket creation error");
         return false;
     }
-    
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port = htons(PORT);
-    
-    // Преобразование IP адреса
-    if (inet_pton(AF_INET, IP, &serv_addr.sin_addr) <= 0) {
-        perror("Invalid address/ Address not supported");
-        close(sock);
-        sock = -1;
+
+    // Подключение к серверу без блокировки, ожидание ограничено TCP_CONNECT_TIMEOUT_MS
+    if (connect(fd, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0 && errno != EINPROGRESS) {
+        close(fd);
         return false;
     }
-    
-    // Подключение к серверу
-    if (connect(sock, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {
-        //perror("Connection Failed");
-        close(sock);
-        sock = -1;
+
+    pollfd fds[2];
+    fds[0] = {fd, POLLOUT, 0};
+    fds[1] = {wakeFd, POLLIN, 0};
+
+    int r;
+    do {
+        r = poll(fds, 2, TCP_CONNECT_TIMEOUT_MS);
+    } while (r < 0 && errno == EINTR);
+
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (r <= 0 || !(fds[0].revents & POLLOUT) || getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0) {
+        close(fd);
         return false;
     }
-    
+
+    std::lock_guard<std::mutex> lock(sendMutex);
+    sock = fd;
+    configureSocket();
+
     printf("Connected to server\n");
     return true;
 }
 
-int InterfaceTCPClient::sendFlyPlaneData(FlyPlaneData& data)
+void InterfaceTCPClient::configureSocket()
 {
-    for (int i = 0; i < 10; ++i)
-    {
-        if (sock > 0)
-            break;
+    // Keepalive и TCP_USER_TIMEOUT: мёртвый сервер обнаруживается за секунды, а не за минуты
+    int enable = 1, idle = 1, interval = 1, count = 3;
+    unsigned int userTimeout = TCP_USER_TIMEOUT_MS;
+    setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+    setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+    setsockopt(sock, IPPROTO_TCP, TCP_USER_TIMEOUT, &userTimeout, sizeof(userTimeout));
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
 
-        // Попытка подключения
-        if (sock < 0)
-            sock = ConnectToServer();
+    // Отправка с MSG_DONTWAIT, ожидание места в буфере ограничено в sendData
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags & ~O_NONBLOCK);
+}
+
+void InterfaceTCPClient::disconnect()
+{
+    std::lock_guard<std::mutex> lock(sendMutex);
+    if (sock >= 0)
+    {
+        // Идущая отправка прерывается, сокет закроет sendData: номер дескриптора не
+        // должен достаться новому соединению, пока send ещё пишет в него
+        if (sending)
+            shutdown(sock, SHUT_RDWR);
         else
-            usleep(1*100*1000);
+            close(sock);
+        sock = -1;
     }
+    state = TCPState::Disconnected;
+}
 
-    if (sock < 0) return -1;
+bool InterfaceTCPClient::sleepFor(int ms)
+{
+    pollfd fd = {wakeFd, POLLIN, 0};
+    poll(&fd, 1, ms);
 
-    unsigned char* serializedData = data.Serialization();
-    int dataSize = data.getSerializedSize();
+    uint64_t value;
+    while (read(wakeFd, &value, sizeof(value)) > 0) {}
 
-    // Get Frame
-    // Get Frame
-    // Get Frame
+    return running;
+}
 
-    ssize_t bytes_sent = send(sock, serializedData, dataSize, MSG_NOSIGNAL);
-    delete[] serializedData;
+void InterfaceTCPClient::managerLoop()
+{
+    std::mt19937 rng(std::random_device{}());
+    int attempt = 0;
 
-    if (bytes_sent <= 0)
+    while (running)
     {
-        close(sock);
-        sock = -1;
+        if (state != TCPState::Connected)
+        {
+            state = TCPState::Connecting;
+            if (ConnectToServer())
+            {
+                state = TCPState::Connected;
+                attempt = 0;
+                continue;
+            }
+
+            state = TCPState::Disconnected;
+
+            // Экспоненциальная задержка, половина которой случайна, чтобы клиенты не синхронизировались
+            int delay = TCP_RECONNECT_MAX_MS;
+            if (attempt < 16)
+                delay = std::min(TCP_RECONNECT_MAX_MS, TCP_RECONNECT_MIN_MS << attempt);
+            ++attempt;
+
+            std::uniform_int_distribution<int> jitter(0, delay / 2);
+            sleepFor(delay / 2 + jitter(rng));
+            continue;
+        }
+
+        // Соединение установлено: ждём разрыва (ошибка, закрытие сервером) или пробуждения
+        int fd;
+        {
+            std::lock_guard<std::mutex> lock(sendMutex);
+            fd = sock;
+        }
+        if (fd < 0)
+        {
+            state = TCPState::Disconnected;
+            continue;
+        }
+
+        pollfd fds[2];
+        fds[0] = {fd, POLLRDHUP, 0};
+        fds[1] = {wakeFd, POLLIN, 0};
+
+        if (poll(fds, 2, 1000) > 0)
+        {
+            if (fds[0].revents & (POLLRDHUP | POLLERR | POLLHUP | POLLNVAL))
+            {
+                printf("Connection to server lost\n");
+                disconnect();
+            }
+            if (fds[1].revents & POLLIN)
+                sleepFor(0);
+        }
     }
+}
+
+int InterfaceTCPClient::sendFlyPlaneData(FlyPlaneData& data)
+{
+    if (!isConnected()) return -1;
+
+    unsigned char* serializedData = data.Serialization();
+    int dataSize = data.getSerializedSize();
+
+    ssize_t bytes_sent = sendData(serializedData, dataSize);
+    delete[] serializedData;
 
     return bytes_sent;
-}
\ No newline at end of file
+}
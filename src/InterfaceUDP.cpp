@@ -1,17 +1,119 @@
 #include "InterfaceUDP.h"
 
-InterfaceUDP::InterfaceUDP(char* ip, int port)
+#include <poll.h>
+#include <algorithm>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <linux/errqueue.h>
+
+// Место под управляющие сообщения одной датаграммы (SCM_TIMESTAMPING или SCM_TIMESTAMPNS)
+#define UDP_CMSG_SPACE (CMSG_SPACE(sizeof(scm_timestamping)) + CMSG_SPACE(sizeof(timespec)))
+
+static void parseTimestamps(msghdr& hdr, RecvTimestamp& stamp)
 {
-    handler = socket(AF_INET, SOCK_DGRAM, 0);
-    
-    sent_addr.sin_family = AF_INET;
-    sent_addr.sin_port = htons(port);
-    inet_pton(AF_INET, ip, &sent_addr.sin_addr);
+    stamp = RecvTimestamp();
+
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET) continue;
+
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING)
+        {
+            scm_timestamping ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            stamp.software = ts.ts[0];
+            stamp.hardware = ts.ts[2];
+        }
+        else if (cmsg->cmsg_type == SCM_TIMESTAMPNS)
+        {
+            memcpy(&stamp.software, CMSG_DATA(cmsg), sizeof(timespec));
+        }
+    }
+}
+
+// Разбирает адрес назначения под семейство сокета. Для двойного стека IPv4 отображается в ::ffff:a.b.c.d
+static bool resolveAddress(const char* ip, int port, int family, sockaddr_storage& addr, socklen_t& len)
+{
+    memset(&addr, 0, sizeof(addr));
+
+    if (family == AF_INET)
+    {
+        sockaddr_in* v4 = reinterpret_cast<sockaddr_in*>(&addr);
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        len = sizeof(sockaddr_in);
+        return inet_pton(AF_INET, ip, &v4->sin_addr) == 1;
+    }
+
+    sockaddr_in6* v6 = reinterpret_cast<sockaddr_in6*>(&addr);
+    v6->sin6_family = AF_INET6;
+    v6->sin6_port = htons(port);
+    len = sizeof(sockaddr_in6);
+
+    if (inet_pton(AF_INET6, ip, &v6->sin6_addr) == 1) return true;
+
+    in_addr v4;
+    if (inet_pton(AF_INET, ip, &v4) != 1) return false;
+    v6->sin6_addr.s6_addr[10] = 0xff;
+    v6->sin6_addr.s6_addr[11] = 0xff;
+    memcpy(&v6->sin6_addr.s6_addr[12], &v4, sizeof(v4));
+    return true;
+}
+
+static bool isMulticast(const sockaddr_storage& addr)
+{
+    if (addr.ss_family == AF_INET)
+        return IN_MULTICAST(ntohl(reinterpret_cast<const sockaddr_in&>(addr).sin_addr.s_addr));
+
+    const in6_addr& a6 = reinterpret_cast<const sockaddr_in6&>(addr).sin6_addr;
+    if (IN6_IS_ADDR_V4MAPPED(&a6))
+    {
+        uint32_t v4;
+        memcpy(&v4, &a6.s6_addr[12], sizeof(v4));
+        return IN_MULTICAST(ntohl(v4));
+    }
+    return IN6_IS_ADDR_MULTICAST(&a6);
+}
+
+InterfaceUDP::InterfaceUDP(const char* ip, int port, bool reusePort)
+    : InterfaceUDP(ip, port, strchr(ip, ':') ? UDPFamily::IPv6 : UDPFamily::IPv4, reusePort)
+{
+}
+
+InterfaceUDP::InterfaceUDP(const char* ip, int port, UDPFamily family, bool reusePort)
+{
+    this->family = family == UDPFamily::IPv4 ? AF_INET : AF_INET6;
+    handler = socket(this->family, SOCK_DGRAM, 0);
+
+    // Несколько сокетов на одном порту, ядро распределяет датаграммы между ними
+    if (reusePort)
+    {
+        int enable = 1;
+        if (setsockopt(handler, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0)
+            perror("SO_REUSEPORT");
+    }
+
+    // Двойной стек: один сокет AF_INET6 принимает и IPv6, и IPv4 (как ::ffff:a.b.c.d)
+    if (family != UDPFamily::IPv4)
+    {
+        int v6only = family == UDPFamily::IPv6 ? 1 : 0;
+        if (setsockopt(handler, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only)) < 0)
+            perror("IPV6_V6ONLY");
+    }
+
+    if (!resolveAddress(ip, port, this->family, sent_addr, sent_len))
+        fprintf(stderr, "Invalid UDP address %s\n", ip);
+
+    // Отправитель в группу не должен перенастраиваться на адрес последнего входящего пакета
+    fixedTarget = isMulticast(sent_addr);
 
-    recv_addr.sin_family = AF_INET;
-    recv_addr.sin_port = htons(port);
-    recv_addr.sin_addr.s_addr = INADDR_ANY;
-    bind(handler, (sockaddr*)&recv_addr, sizeof(recv_addr));
+    socklen_t recv_len;
+    resolveAddress(this->family == AF_INET ? "0.0.0.0" : "::", port, this->family, recv_addr, recv_len);
+    bind(handler, (sockaddr*)&recv_addr, recv_len);
+
+    cancelFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
 
     std::cout << "Сокет UDP создан..." << std::endl;
 }
@@ -19,17 +121,313 @@ InterfaceUDP::InterfaceUDP(char* ip, int port)
 InterfaceUDP::~InterfaceUDP()
 {
     if (handler != -1) close(handler);
+    if (cancelFd != -1) close(cancelFd);
+}
+
+bool InterfaceUDP::enableTimestamps(const char* hwInterface)
+{
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+
+    if (hwInterface != nullptr)
+    {
+        // Аппаратные метки требуют включения на самой сетевой карте (нужен CAP_NET_ADMIN)
+        hwtstamp_config config{};
+        config.tx_type = HWTSTAMP_TX_OFF;
+        config.rx_filter = HWTSTAMP_FILTER_ALL;
+
+        ifreq ifr{};
+        strncpy(ifr.ifr_name, hwInterface, IFNAMSIZ - 1);
+        ifr.ifr_data = reinterpret_cast<char*>(&config);
+
+        if (ioctl(handler, SIOCSHWTSTAMP, &ifr) == 0 && config.rx_filter != HWTSTAMP_FILTER_NONE)
+            flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+        else
+            perror("SIOCSHWTSTAMP");
+    }
+
+    if (setsockopt(handler, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0)
+    {
+        timestamping = true;
+        return true;
+    }
+
+    // Старые ядра: только программные метки в наносекундах
+    int enable = 1;
+    if (setsockopt(handler, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0)
+    {
+        timestamping = true;
+        return true;
+    }
+
+    perror("SO_TIMESTAMPNS");
+    return false;
+}
+
+bool InterfaceUDP::membership(const char* group, const char* iface, int option)
+{
+    group_req req{};
+    req.gr_interface = iface ? if_nametoindex(iface) : 0;
+    if (iface && req.gr_interface == 0) {
+        perror("if_nametoindex");
+        return false;
+    }
+
+    // IPv4-группа на сокете AF_INET6 задаётся обычным sockaddr_in и на уровне IPPROTO_IP:
+    // уровень выбирается по семейству группы, а не сокета (IPPROTO_IPV6 даёт EADDRNOTAVAIL)
+    socklen_t len;
+    bool v6group = strchr(group, ':') != nullptr;
+    if (!resolveAddress(group, 0, v6group ? AF_INET6 : AF_INET, req.gr_group, len) || !isMulticast(req.gr_group)) {
+        fprintf(stderr, "Invalid multicast group %s\n", group);
+        return false;
+    }
+
+    int level = v6group ? IPPROTO_IPV6 : IPPROTO_IP;
+    if (setsockopt(handler, level, option, &req, sizeof(req)) < 0) {
+        perror(option == MCAST_JOIN_GROUP ? "MCAST_JOIN_GROUP" : "MCAST_LEAVE_GROUP");
+        return false;
+    }
+
+    return true;
+}
+
+bool InterfaceUDP::joinGroup(const char* group, const char* iface)
+{
+    return membership(group, iface, MCAST_JOIN_GROUP);
+}
+
+bool InterfaceUDP::leaveGroup(const char* group, const char* iface)
+{
+    return membership(group, iface, MCAST_LEAVE_GROUP);
+}
+
+bool InterfaceUDP::setMulticastTTL(int ttl)
+{
+    // Для двойного стека IPv4-пакеты в группу тоже идут через сокет AF_INET6, задаём оба значения
+    bool ok = true;
+    if (family == AF_INET6)
+        ok = setsockopt(handler, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &ttl, sizeof(ttl)) == 0;
+    if (sendsIPv4())
+        ok = setsockopt(handler, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) == 0 && ok;
+
+    if (!ok) perror("multicast TTL");
+    return ok;
+}
+
+bool InterfaceUDP::setMulticastInterface(const char* iface)
+{
+    int index = if_nametoindex(iface);
+    if (index == 0) {
+        perror("if_nametoindex");
+        return false;
+    }
+
+    // Как и TTL, для IPv4-получателя на двойном стеке задаются оба уровня
+    bool ok = true;
+    if (family == AF_INET6)
+        ok = setsockopt(handler, IPPROTO_IPV6, IPV6_MULTICAST_IF, &index, sizeof(index)) == 0;
+    if (sendsIPv4())
+    {
+        ip_mreqn req{};
+        req.imr_ifindex = index;
+        ok = setsockopt(handler, IPPROTO_IP, IP_MULTICAST_IF, &req, sizeof(req)) == 0 && ok;
+    }
+
+    if (!ok) perror("multicast interface");
+    return ok;
+}
+
+bool InterfaceUDP::setMulticastLoop(bool enable)
+{
+    int value = enable ? 1 : 0;
+    bool ok = true;
+    if (family == AF_INET6)
+        ok = setsockopt(handler, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &value, sizeof(value)) == 0;
+    if (sendsIPv4())
+        ok = setsockopt(handler, IPPROTO_IP, IP_MULTICAST_LOOP, &value, sizeof(value)) == 0 && ok;
+
+    if (!ok) perror("multicast loop");
+    return ok;
+}
+
+// Пакеты уходят по IPv4: сокет AF_INET или получатель на двойном стеке - ::ffff:a.b.c.d
+bool InterfaceUDP::sendsIPv4() const
+{
+    if (family == AF_INET)
+        return true;
+    return sent_addr.ss_family == AF_INET6
+        && IN6_IS_ADDR_V4MAPPED(&reinterpret_cast<const sockaddr_in6&>(sent_addr).sin6_addr);
+}
+
+void InterfaceUDP::rememberSender(const sockaddr_storage& from, socklen_t len)
+{
+    if (fixedTarget) return;
+
+    sent_addr = from;
+    sent_len = len;
 }
 
 int InterfaceUDP::sendTo(uint8_t buffer[], uint16_t len)
 {
-    return sendto(handler, buffer, len, 0, (sockaddr*)&sent_addr, sizeof(sent_addr));
+    return sendto(handler, buffer, len, 0, (sockaddr*)&sent_addr, sent_len);
 }
 
 ssize_t InterfaceUDP::recvFrom(uint8_t buffer[], uint16_t len)
 {
-    socklen_t sent_len = sizeof(sent_addr);
-    return recvfrom(handler, buffer, len, 0, (sockaddr*)&sent_addr, &sent_len);
+    sockaddr_storage from;
+    socklen_t from_len = sizeof(from);
+
+    ssize_t n = recvfrom(handler, buffer, len, 0, (sockaddr*)&from, &from_len);
+    if (n >= 0) rememberSender(from, from_len);
+    return n;
+}
+
+ssize_t InterfaceUDP::recvFrom(uint8_t buffer[], uint16_t len, RecvTimestamp& stamp, int flags)
+{
+    iovec iov{buffer, len};
+    alignas(cmsghdr) char control[UDP_CMSG_SPACE];
+
+    sockaddr_storage from;
+
+    msghdr hdr{};
+    hdr.msg_name = &from;
+    hdr.msg_namelen = sizeof(from);
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control;
+    hdr.msg_controllen = sizeof(control);
+
+    ssize_t n = recvmsg(handler, &hdr, flags);
+    if (n >= 0)
+    {
+        rememberSender(from, hdr.msg_namelen);
+        parseTimestamps(hdr, stamp);
+    }
+    else
+        stamp = RecvTimestamp();
+
+    return n;
+}
+
+int InterfaceUDP::recvBatch(UDPDatagram* datagrams, int count, int flags)
+{
+    if (count <= 0) return 0;
+    if (count > UDP_BATCH_MAX) count = UDP_BATCH_MAX;
+
+    mmsghdr msgs[UDP_BATCH_MAX];
+    iovec iovs[UDP_BATCH_MAX];
+    alignas(cmsghdr) char control[UDP_BATCH_MAX][UDP_CMSG_SPACE];
+
+    memset(msgs, 0, sizeof(mmsghdr) * count);
+    for (int i = 0; i < count; ++i)
+    {
+        iovs[i].iov_base = datagrams[i].data;
+        iovs[i].iov_len = datagrams[i].capacity;
+
+        msghdr& hdr = msgs[i].msg_hdr;
+        hdr.msg_name = &datagrams[i].from;
+        hdr.msg_namelen = sizeof(datagrams[i].from);
+        hdr.msg_iov = &iovs[i];
+        hdr.msg_iovlen = 1;
+        if (timestamping)
+        {
+            hdr.msg_control = control[i];
+            hdr.msg_controllen = UDP_CMSG_SPACE;
+        }
+    }
+
+    int received = recvmmsg(handler, msgs, count, flags, nullptr);
+    if (received <= 0) return received;
+
+    for (int i = 0; i < received; ++i)
+    {
+        datagrams[i].length = msgs[i].msg_len;
+        datagrams[i].fromLen = msgs[i].msg_hdr.msg_namelen;
+        parseTimestamps(msgs[i].msg_hdr, datagrams[i].stamp);
+    }
+
+    // Как и recvFrom, отвечаем последнему отправителю
+    rememberSender(datagrams[received - 1].from, datagrams[received - 1].fromLen);
+
+    return received;
+}
+
+bool InterfaceUDP::waitReadable(std::chrono::steady_clock::time_point deadline)
+{
+    pollfd fds[2];
+    fds[0] = {handler, POLLIN, 0};
+    fds[1] = {cancelFd, POLLIN, 0};
+
+    while (true)
+    {
+        if (isCancelled()) {
+            errno = ECANCELED;
+            return false;
+        }
+
+        // Округляем вверх, чтобы не крутиться вхолостую последнюю миллисекунду
+        auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        int timeout = static_cast<int>(std::min<int64_t>(std::max<int64_t>(left.count(), 0), 60000));
+
+        int r = poll(fds, 2, timeout);
+        if (r < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (fds[1].revents & POLLIN) {
+            errno = ECANCELED;
+            return false;
+        }
+        if (fds[0].revents & (POLLIN | POLLERR)) return true;
+        if (r == 0 && std::chrono::steady_clock::now() >= deadline) {
+            errno = ETIMEDOUT;
+            return false;
+        }
+    }
+}
+
+ssize_t InterfaceUDP::recvUntil(uint8_t buffer[], uint16_t len, std::chrono::steady_clock::time_point deadline)
+{
+    while (waitReadable(deadline))
+    {
+        sockaddr_storage from;
+        socklen_t from_len = sizeof(from);
+
+        ssize_t n = recvfrom(handler, buffer, len, MSG_DONTWAIT, (sockaddr*)&from, &from_len);
+        if (n >= 0) rememberSender(from, from_len);
+        if (n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return n;
+    }
+
+    return -1;
+}
+
+ssize_t InterfaceUDP::recvUntil(uint8_t buffer[], uint16_t len, RecvTimestamp& stamp, std::chrono::steady_clock::time_point deadline)
+{
+    while (waitReadable(deadline))
+    {
+        ssize_t n = recvFrom(buffer, len, stamp, MSG_DONTWAIT);
+        if (n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return n;
+    }
+
+    return -1;
+}
+
+void InterfaceUDP::cancel()
+{
+    uint64_t one = 1;
+    if (write(cancelFd, &one, sizeof(one)) < 0) perror("cancel");
+}
+
+void InterfaceUDP::resetCancel()
+{
+    uint64_t value;
+    while (read(cancelFd, &value, sizeof(value)) > 0) {}
+}
+
+bool InterfaceUDP::isCancelled() const
+{
+    pollfd fd = {cancelFd, POLLIN, 0};
+    return poll(&fd, 1, 0) > 0 && (fd.revents & POLLIN);
 }
 
 void InterfaceUDP::sendFlyPlaneData(FlyPlaneData& data)
@@ -46,7 +444,6 @@ int InterfaceUDP::readFlyPlaneData(FlyPlaneData &data)
 {
     unsigned char* buffer = new unsigned char [BUFFER_SIZE];
 
-    socklen_t len = sizeof(sent_addr);
     ssize_t bytesReceived = recvFrom(buffer, sizeof(buffer));
     
     if (bytesReceived > 0) 
@@ -0,0 +1,82 @@
+#include "MavlinkChannel.h"
+
+#include <chrono>
+#include <cstring>
+
+// Отметка времени подписи: десятки микросекунд с 1 января 2015 года (GMT)
+static uint64_t signingTimestamp()
+{
+    const uint64_t epoch2015 = 1420070400ULL * 100000;
+    auto since1970 = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    return static_cast<uint64_t>(since1970.count()) / 10 - epoch2015;
+}
+
+MavlinkChannel::MavlinkChannel()
+{
+    memset(&status, 0, sizeof(status));
+    memset(&rxBuffer, 0, sizeof(rxBuffer));
+    memset(&signing, 0, sizeof(signing));
+    memset(&streams, 0, sizeof(streams));
+}
+
+bool MavlinkChannel::parse(const uint8_t*& p, const uint8_t* end, mavlink_frame_view_t& frame)
+{
+    return mavlink_parse_buffer_state(&rxBuffer, &status, &p, end, &frame) == MAVLINK_FRAMING_OK;
+}
+
+bool MavlinkChannel::parseChar(uint8_t c, mavlink_message_t& msg)
+{
+    return mavlink_parse_char_buffer(&rxBuffer, &status, c, &msg, nullptr) == MAVLINK_FRAMING_OK;
+}
+
+void MavlinkChannel::enableSigning(const uint8_t (&key)[32], uint8_t linkId, bool signOutgoing,
+                                   mavlink_accept_unsigned_t acceptUnsigned)
+{
+    memcpy(signing.secret_key, key, sizeof(signing.secret_key));
+    signing.link_id = linkId;
+    signing.flags = signOutgoing ? MAVLINK_SIGNING_FLAG_SIGN_OUTGOING : 0;
+    signing.timestamp = signingTimestamp();
+    signing.accept_unsigned_callback = acceptUnsigned;
+    signing.last_status = MAVLINK_SIGNING_STATUS_NONE;
+
+    status.signing = &signing;
+    status.signing_streams = &streams;
+}
+
+void MavlinkChannel::disableSigning()
+{
+    status.signing = nullptr;
+    status.signing_streams = nullptr;
+    memset(&signing, 0, sizeof(signing));
+}
+
+bool MavlinkChannel::signingEnabled() const
+{
+    return status.signing != nullptr;
+}
+
+uint16_t MavlinkChannel::encode(const mavlink_message_t& msg, uint8_t* out)
+{
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msg.msgid);
+    if (entry == nullptr)
+        return 0;
+
+    // Сообщение собрано mavlink_msg_*_pack на общем канале MAVLINK_COMM_0: номер и подпись
+    // переписываются по состоянию этого канала, полезная нагрузка не меняется
+    mavlink_message_t framed = msg;
+    mavlink_finalize_message_buffer(&framed, msg.sysid, msg.compid, &status, entry->min_msg_len, msg.len,
+                                    entry->crc_extra);
+    return mavlink_msg_to_send_buffer(out, &framed);
+}
+
+void MavlinkChannel::reset()
+{
+    status.parse_state = MAVLINK_PARSE_STATE_IDLE;
+    status.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+}
+
+const mavlink_status_t& MavlinkChannel::getStatus() const
+{
+    return status;
+}
@@ -0,0 +1,69 @@
+#include "MavlinkCrc.h"
+
+#ifdef HAVE_PCLMUL_KERNELS
+static bool hasPCLMUL()
+{
+    static const bool supported = __builtin_cpu_supports("pclmul");
+    return supported;
+}
+#endif
+
+// tables[0][i] - crc_accumulate(i) от нулевого crc, tables[k][i] - то же, за которым ещё k нулевых байт
+typedef uint16_t CrcTable[256];
+
+static const CrcTable* crcMcrf4xxTables()
+{
+    static CrcTable tables[8];
+    static bool ready = [] {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint16_t c = 0;
+            crc_accumulate(static_cast<uint8_t>(i), &c);
+            tables[0][i] = c;
+        }
+        for (int k = 1; k < 8; ++k)
+            for (uint32_t i = 0; i < 256; ++i)
+                tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+        return true;
+    }();
+    (void)ready;
+    return tables;
+}
+
+uint16_t crcMcrf4xxSlice8(uint16_t crc, const uint8_t* data, size_t size)
+{
+    const CrcTable* t = crcMcrf4xxTables();
+
+    // 16-битный crc целиком выдвигается за 8 байт, поэтому каждый байт - независимый поиск
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        crc = t[7][data[0] ^ (crc & 0xFF)] ^ t[6][data[1] ^ (crc >> 8)] ^
+              t[5][data[2]] ^ t[4][data[3]] ^ t[3][data[4]] ^ t[2][data[5]] ^
+              t[1][data[6]] ^ t[0][data[7]];
+    }
+
+    while (size--)
+        crc_accumulate(*data++, &crc);
+    return crc;
+}
+
+uint16_t crcMcrf4xxUpdate(uint16_t crc, const uint8_t* data, size_t size)
+{
+#ifdef HAVE_PCLMUL_KERNELS
+    if (size >= MAVLINK_CRC_FOLD_MIN && hasPCLMUL())
+        return crcMcrf4xxFoldPclmul(crc, data, size);
+#endif
+    return crcMcrf4xxSlice8(crc, data, size);
+}
+
+#ifdef HAVE_CRC_ACCUMULATE_BUFFER
+uint16_t crc_calculate(const uint8_t* pBuffer, uint16_t length)
+{
+    return crcMcrf4xxUpdate(X25_INIT_CRC, pBuffer, length);
+}
+
+void crc_accumulate_buffer(uint16_t* crcAccum, const char* pBuffer, uint16_t length)
+{
+    *crcAccum = crcMcrf4xxUpdate(*crcAccum, reinterpret_cast<const uint8_t*>(pBuffer), length);
+}
+#endif
@@ -0,0 +1,54 @@
+#include "MavlinkCrc.h"
+
+#include <wmmintrin.h>
+
+// Файл собирается с -mpclmul, вызывается только если процессор поддерживает PCLMULQDQ.
+// Биты CRC отражённые: бит 0 первого байта - старшая степень. 16 байт X перед
+// следующими 16 заменяются остатком X * x^128 mod P той же длины:
+// младшая половина H умножается на x^191 mod P, старшая L - на x^127 mod P
+// (произведение отражённых чисел сдвинуто на одну степень)
+
+// x^n mod P, P = x^16 + x^12 + x^5 + 1, в отражённом виде в 64 битах
+static uint64_t foldConstant(unsigned n)
+{
+    uint32_t r = 1;
+    for (unsigned i = 0; i < n; ++i)
+    {
+        r <<= 1;
+        if (r & 0x10000)
+            r ^= 0x11021;
+    }
+
+    uint64_t k = 0;
+    for (int d = 0; d < 16; ++d)
+        if (r & (1u << d))
+            k |= 1ull << (63 - d);
+    return k;
+}
+
+uint16_t crcMcrf4xxFoldPclmul(uint16_t crc, const uint8_t* data, size_t size)
+{
+    if (size < 32)
+        return crcMcrf4xxSlice8(crc, data, size);
+
+    static const __m128i k = _mm_set_epi64x(static_cast<long long>(foldConstant(127)),
+                                            static_cast<long long>(foldConstant(191)));
+
+    // Начальный crc складывается с первыми двумя байтами
+    __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), _mm_cvtsi32_si128(crc));
+    data += 16;
+    size -= 16;
+
+    for (; size >= 16; data += 16, size -= 16)
+    {
+        __m128i h = _mm_clmulepi64_si128(x, k, 0x00);
+        __m128i l = _mm_clmulepi64_si128(x, k, 0x11);
+        x = _mm_xor_si128(_mm_xor_si128(h, l), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+    }
+
+    // Свёрнутые 16 байт сравнимы с обработанной частью по модулю P: их crc от нуля - текущий crc
+    uint8_t folded[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(folded), x);
+    crc = crcMcrf4xxSlice8(0, folded, sizeof(folded));
+    return crcMcrf4xxSlice8(crc, data, size);
+}
@@ -0,0 +1,297 @@
+#include "MavlinkFtp.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+MavlinkFtpClient::MavlinkFtpClient(Sender send, const MissionTransferSettings& settings)
+    : send(std::move(send)), settings(settings)
+{
+}
+
+std::future<MavlinkFtpResult> MavlinkFtpClient::startWrite(const std::string& filePath, std::vector<uint8_t> data,
+                                                           Clock::time_point now)
+{
+    if (state != State::Idle)
+        cancel(now);
+
+    file = std::move(data);
+    writing = true;
+    return begin(FTP_OP_CREATE_FILE, filePath, now);
+}
+
+std::future<MavlinkFtpResult> MavlinkFtpClient::startRead(const std::string& filePath, Clock::time_point now)
+{
+    if (state != State::Idle)
+        cancel(now);
+
+    file.clear();
+    writing = false;
+    return begin(FTP_OP_OPEN_FILE_RO, filePath, now);
+}
+
+std::future<MavlinkFtpResult> MavlinkFtpClient::begin(uint8_t openOpcode, const std::string& filePath, Clock::time_point now)
+{
+    promise = std::promise<MavlinkFtpResult>();
+    result = MavlinkFtpResult();
+    std::future<MavlinkFtpResult> future = promise.get_future();
+
+    path = filePath;
+    session = 0;
+    nextOffset = 0;
+    inFlight.clear();
+    fileSize = 0;
+    readOffset = 0;
+    retries = 0;
+    started = now;
+    deadline = now + settings.deadline;
+    state = State::Opening;
+
+    if (path.size() > MAVLINK_FTP_DATA_MAX)
+    {
+        finish(false, false, FTP_ERR_INVALID_DATA_SIZE, now);
+        return future;
+    }
+
+    transmit(seq++, openOpcode, 0, reinterpret_cast<const uint8_t*>(path.data()), static_cast<uint8_t>(path.size()), now);
+    return future;
+}
+
+void MavlinkFtpClient::transmit(uint16_t requestSeq, uint8_t opcode, uint32_t offset, const uint8_t* data, uint8_t size,
+                                Clock::time_point now)
+{
+    MavlinkFtpHeader header;
+    header.seq = requestSeq;
+    header.session = session;
+    header.opcode = opcode;
+    header.size = size;
+    header.offset = offset;
+
+    uint8_t payload[MAVLINK_FTP_PAYLOAD_SIZE] = {};
+    uint8_t* body = wireEncode(header, payload);
+    // У BurstReadFile size - желаемая длина ответа, данных в запросе нет
+    if (data != nullptr)
+        memcpy(body, data, size);
+
+    mavlink_msg_file_transfer_protocol_pack(settings.systemId, settings.componentId, &lastMessage, 0,
+                                            settings.targetSystem, settings.targetComponent, payload);
+    retryAt = now + settings.retryTimeout;
+    send(lastMessage);
+}
+
+void MavlinkFtpClient::sendChunks(Clock::time_point now)
+{
+    while (inFlight.size() < settings.readbackWindow && nextOffset < file.size())
+    {
+        uint8_t size = static_cast<uint8_t>(std::min<size_t>(MAVLINK_FTP_DATA_MAX, file.size() - nextOffset));
+        Request request = { seq++, nextOffset, size };
+
+        transmit(request.seq, FTP_OP_WRITE_FILE, request.offset, file.data() + request.offset, request.size, now);
+        inFlight.push_back(request);
+        nextOffset += size;
+    }
+}
+
+void MavlinkFtpClient::requestBurst(Clock::time_point now)
+{
+    transmit(seq++, FTP_OP_BURST_READ_FILE, readOffset, nullptr, MAVLINK_FTP_DATA_MAX, now);
+}
+
+void MavlinkFtpClient::close(Clock::time_point now)
+{
+    state = State::Closing;
+    transmit(seq++, FTP_OP_TERMINATE_SESSION, 0, nullptr, 0, now);
+}
+
+void MavlinkFtpClient::handleMessage(const mavlink_message_t& msg, Clock::time_point now)
+{
+    mavlinkDispatchTo(*this, msg, now);
+}
+
+void MavlinkFtpClient::handle(const mavlink_file_transfer_protocol_t& ftp, const mavlink_frame_view_t& frame,
+                              Clock::time_point now)
+{
+    if (state == State::Idle || frame.sysid != settings.targetSystem || ftp.target_system != settings.systemId)
+        return;
+
+    MavlinkFtpHeader header;
+    const uint8_t* data = wireDecode(header, ftp.payload);
+    if (header.size > MAVLINK_FTP_DATA_MAX)
+        return;
+
+    if (header.opcode == FTP_OP_ACK)
+    {
+        onAck(header, data, now);
+        return;
+    }
+    if (header.opcode != FTP_OP_NAK)
+        return;
+
+    uint8_t error = header.size > 0 ? data[0] : static_cast<uint8_t>(FTP_ERR_FAIL);
+
+    // Конец файла при чтении - нормальное завершение, если размер не был известен точно
+    if (state == State::Reading && error == FTP_ERR_EOF)
+    {
+        fileSize = readOffset;
+        close(now);
+        return;
+    }
+
+    std::cerr << "MAVLink FTP: " << path << " refused, opcode " << static_cast<int>(header.reqOpcode)
+              << ", error " << static_cast<int>(error) << std::endl;
+    finish(false, false, error, now);
+}
+
+void MavlinkFtpClient::onAck(const MavlinkFtpHeader& header, const uint8_t* data, Clock::time_point now)
+{
+    switch (state)
+    {
+    case State::Opening:
+    {
+        if (header.reqOpcode != (writing ? FTP_OP_CREATE_FILE : FTP_OP_OPEN_FILE_RO))
+            break;
+
+        session = header.session;
+        retries = 0;
+
+        if (writing)
+        {
+            state = State::Writing;
+            sendChunks(now);
+            if (inFlight.empty())
+                close(now);
+            break;
+        }
+
+        // Ответ на OpenFileRO несёт размер файла
+        if (header.size >= sizeof(uint32_t))
+            fileSize = WireCodec<uint32_t>::get(data);
+        file.reserve(fileSize);
+
+        state = State::Reading;
+        if (header.size >= sizeof(uint32_t) && fileSize == 0)
+            close(now);
+        else
+            requestBurst(now);
+        break;
+    }
+    case State::Writing:
+    {
+        if (header.reqOpcode != FTP_OP_WRITE_FILE)
+            break;
+
+        // Ответ идёт с номером запроса + 1
+        uint16_t requestSeq = static_cast<uint16_t>(header.seq - 1);
+        auto it = std::find_if(inFlight.begin(), inFlight.end(),
+                               [&](const Request& request) { return request.seq == requestSeq; });
+        if (it == inFlight.end())
+            break;
+
+        inFlight.erase(it);
+        retries = 0;
+        retryAt = now + settings.retryTimeout;
+
+        sendChunks(now);
+        if (inFlight.empty())
+            close(now);
+        break;
+    }
+    case State::Reading:
+    {
+        if (header.session != session || (header.reqOpcode != FTP_OP_BURST_READ_FILE && header.reqOpcode != FTP_OP_READ_FILE))
+            break;
+
+        // Принимаются только данные, продолжающие уже полученные; после потери
+        // остаток пачки отбрасывается и запрашивается заново
+        if (header.offset <= readOffset && header.offset + header.size > readOffset)
+        {
+            uint32_t skip = readOffset - header.offset;
+            file.insert(file.end(), data + skip, data + header.size);
+            readOffset = header.offset + header.size;
+            retries = 0;
+            retryAt = now + settings.retryTimeout;
+        }
+
+        if (fileSize > 0 && readOffset >= fileSize)
+            close(now);
+        else if (header.burstComplete)
+            requestBurst(now);
+        break;
+    }
+    case State::Closing:
+        if (header.reqOpcode == FTP_OP_TERMINATE_SESSION)
+            finish(true, false, FTP_ERR_NONE, now);
+        break;
+    default: break;
+    }
+}
+
+void MavlinkFtpClient::poll(Clock::time_point now)
+{
+    if (state == State::Idle)
+        return;
+
+    if (now >= deadline || (now >= retryAt && retries >= settings.maxRetries))
+    {
+        std::cerr << "MAVLink FTP: " << path << " timeout" << std::endl;
+        finish(false, true, FTP_ERR_NONE, now);
+        return;
+    }
+
+    if (now < retryAt)
+        return;
+
+    retries++;
+    result.retransmits++;
+
+    switch (state)
+    {
+    case State::Writing:
+        // Запись по смещению идемпотентна: повторяются все неподтверждённые куски
+        for (const Request& request : inFlight)
+            transmit(request.seq, FTP_OP_WRITE_FILE, request.offset, file.data() + request.offset, request.size, now);
+        break;
+    case State::Reading:
+        requestBurst(now);
+        break;
+    default:
+        retryAt = now + settings.retryTimeout;
+        send(lastMessage);
+        break;
+    }
+}
+
+void MavlinkFtpClient::cancel(Clock::time_point now)
+{
+    if (state != State::Idle)
+        finish(false, false, FTP_ERR_NONE, now);
+}
+
+void MavlinkFtpClient::finish(bool ok, bool timedOut, uint8_t nakError, Clock::time_point now)
+{
+    // Сессия на автопилоте одна на всех, брошенная мешает следующему клиенту
+    if (!ok && state != State::Opening && state != State::Idle)
+        transmit(seq++, FTP_OP_TERMINATE_SESSION, 0, nullptr, 0, now);
+
+    state = State::Idle;
+
+    result.ok = ok;
+    result.timedOut = timedOut;
+    result.nakError = nakError;
+    result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - started);
+    if (ok && !writing)
+        result.data = std::move(file);
+    file.clear();
+
+    promise.set_value(std::move(result));
+}
+
+bool MavlinkFtpClient::active() const
+{
+    return state != State::Idle;
+}
+
+MavlinkFtpClient::Clock::time_point MavlinkFtpClient::nextWakeup() const
+{
+    return std::min(retryAt, deadline);
+}
@@ -0,0 +1,129 @@
+// Диалект ardupilotmega подключается первым, чтобы MAVLINK_MESSAGE_CRCS и
+// MAVLINK_MESSAGE_NAMES были его (он включает common), а не только common
+#include "../Mavlink_Lib/ardupilotmega/mavlink.h"
+
+#include "MavlinkMsgTable.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+
+struct MsgName
+{
+    const char* name;
+    uint32_t msgid;
+};
+
+constexpr mavlink_msg_entry_t entries[] = MAVLINK_MESSAGE_CRCS;
+constexpr MsgName names[] = MAVLINK_MESSAGE_NAMES;
+
+constexpr size_t ENTRY_COUNT = sizeof(entries) / sizeof(entries[0]);
+constexpr uint32_t LAST_PAGE = entries[ENTRY_COUNT - 1].msgid >> 8;
+
+// Таблица имён с открытой адресацией, заполнена не больше чем наполовину
+constexpr size_t NAME_SLOTS = 1024;
+
+static_assert(sizeof(names) / sizeof(names[0]) == ENTRY_COUNT, "MAVLINK_MESSAGE_NAMES and MAVLINK_MESSAGE_CRCS differ");
+static_assert(ENTRY_COUNT * 2 <= NAME_SLOTS, "NAME_SLOTS too small");
+
+constexpr bool sortedById()
+{
+    for (size_t i = 1; i < ENTRY_COUNT; ++i)
+        if (entries[i - 1].msgid >= entries[i].msgid)
+            return false;
+    return true;
+}
+
+constexpr size_t usedPages()
+{
+    size_t count = 0;
+    for (size_t i = 0; i < ENTRY_COUNT; ++i)
+        if (i == 0 || (entries[i - 1].msgid >> 8) != (entries[i].msgid >> 8))
+            ++count;
+    return count;
+}
+
+static_assert(sortedById(), "MAVLINK_MESSAGE_CRCS must be sorted by msgid");
+static_assert(usedPages() < UINT8_MAX, "too many msgid pages");
+
+constexpr uint32_t nameHash(const char* s)
+{
+    uint32_t h = 2166136261u;   // FNV-1a
+    while (*s)
+        h = (h ^ static_cast<uint8_t>(*s++)) * 16777619u;
+    return h;
+}
+
+struct MsgTables
+{
+    uint8_t page[LAST_PAGE + 1];            // номер страницы msgid >> 8 + 1, 0 - пустая
+    uint16_t slot[usedPages()][256];        // индекс в entries + 1, 0 - нет сообщения
+    uint16_t nameOf[ENTRY_COUNT];           // индекс в names для entries[i]
+    uint16_t nameSlot[NAME_SLOTS];          // индекс в names + 1, 0 - пусто
+
+    constexpr int find(uint32_t msgid) const
+    {
+        if ((msgid >> 8) > LAST_PAGE || page[msgid >> 8] == 0)
+            return -1;
+        return slot[page[msgid >> 8] - 1][msgid & 0xFF] - 1;
+    }
+};
+
+constexpr MsgTables makeTables()
+{
+    MsgTables t{};
+
+    uint8_t pages = 0;
+    for (size_t i = 0; i < ENTRY_COUNT; ++i)
+    {
+        uint32_t p = entries[i].msgid >> 8;
+        if (t.page[p] == 0)
+            t.page[p] = ++pages;
+        t.slot[t.page[p] - 1][entries[i].msgid & 0xFF] = static_cast<uint16_t>(i + 1);
+    }
+
+    for (size_t n = 0; n < ENTRY_COUNT; ++n)
+    {
+        t.nameOf[t.find(names[n].msgid)] = static_cast<uint16_t>(n);
+
+        size_t s = nameHash(names[n].name) & (NAME_SLOTS - 1);
+        while (t.nameSlot[s] != 0)
+            s = (s + 1) & (NAME_SLOTS - 1);
+        t.nameSlot[s] = static_cast<uint16_t>(n + 1);
+    }
+    return t;
+}
+
+constexpr MsgTables tables = makeTables();
+
+static_assert(tables.find(MAVLINK_MSG_ID_HEARTBEAT) >= 0 && tables.find(MAVLINK_MSG_ID_AUTOPILOT_VERSION_REQUEST) >= 0,
+              "common and ardupilotmega messages must both be present");
+
+} // namespace
+
+#ifdef MAVLINK_GET_MSG_ENTRY
+const mavlink_msg_entry_t* mavlink_get_msg_entry(uint32_t msgid)
+{
+    int i = tables.find(msgid);
+    return i < 0 ? NULL : &entries[i];
+}
+#endif
+
+const mavlink_msg_entry_t* mavlinkMsgEntryByName(const char* name)
+{
+    for (size_t s = nameHash(name) & (NAME_SLOTS - 1); tables.nameSlot[s] != 0; s = (s + 1) & (NAME_SLOTS - 1))
+    {
+        const MsgName& candidate = names[tables.nameSlot[s] - 1];
+        if (strcmp(candidate.name, name) == 0)
+            return &entries[tables.find(candidate.msgid)];
+    }
+    return nullptr;
+}
+
+const char* mavlinkMsgName(uint32_t msgid)
+{
+    int i = tables.find(msgid);
+    return i < 0 ? nullptr : names[tables.nameOf[i]].name;
+}
@@ -0,0 +1,131 @@
+#include "MissionCache.h"
+#include "WireFormat.h"
+
+#include <cmath>
+#include <cstdlib>
+
+// Пункт миссии соответствует точке маршрута с точностью tolerance (единицы 1e-7 градуса).
+// Высота передаётся в метрах float и хранится автопилотом в сантиметрах
+static bool itemMatches(const mavlink_mission_item_int_t& item, const WGS84CoordInt& point, int32_t tolerance)
+{
+    if (item.command != MAV_CMD_NAV_WAYPOINT)
+        return false;
+    if (item.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT && item.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT_INT)
+        return false;
+
+    return std::abs(static_cast<int64_t>(item.x) - point.lat) <= tolerance
+        && std::abs(static_cast<int64_t>(item.y) - point.lon) <= tolerance
+        && std::llabs(std::llround(item.z * 1000.0) - point.alt) < MissionCache::ALTITUDE_TOLERANCE;
+}
+
+WGS84CoordInt MissionCache::quantize(const WGS84CoordInt& point)
+{
+    WGS84CoordInt result = point;
+    result.alt = static_cast<int32_t>(std::llround(point.alt / 10.0) * 10);
+    return result;
+}
+
+uint32_t MissionCache::hashPoints(const WGS84CoordInt* points, size_t count)
+{
+    unsigned char encoded[ROUTE_POINT_SIZE];
+    uint32_t crc = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        encodeRoutePoint(quantize(points[i]), encoded);
+        crc = crc32Update(crc, encoded, sizeof(encoded));
+    }
+    return crc;
+}
+
+bool MissionCache::known() const
+{
+    return valid;
+}
+
+bool MissionCache::matches(const WGS84CoordInt* coords, size_t count) const
+{
+    if (!valid || count != points.size() || hashPoints(coords, count) != hash)
+        return false;
+
+    // Совпадение хеша ещё не равенство, загрузку пропускаем только при тех же пунктах
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (quantize(coords[i]) != quantize(points[i]))
+            return false;
+    }
+    return true;
+}
+
+void MissionCache::assign(const WGS84CoordInt* coords, size_t count)
+{
+    points.assign(coords, coords + count);
+    hash = hashPoints(coords, count);
+    valid = true;
+}
+
+void MissionCache::clear()
+{
+    points.clear();
+    hash = 0;
+    valid = false;
+}
+
+bool MissionCache::assignItems(const mavlink_mission_item_int_t* items, size_t count)
+{
+    clear();
+
+    // Пустая миссия тоже известное состояние
+    if (count == 0)
+    {
+        valid = true;
+        hash = hashPoints(nullptr, 0);
+        return true;
+    }
+
+    std::vector<WGS84CoordInt> restored(count - 1);
+    for (size_t seq = 1; seq < count; ++seq)
+    {
+        WGS84CoordInt& point = restored[seq - 1];
+        point.lat = items[seq].x;
+        point.lon = items[seq].y;
+        point.alt = static_cast<int32_t>(std::lround(items[seq].z * 1000.0));
+
+        if (!itemMatches(items[seq], point, 0))
+            return false;
+    }
+
+    assign(restored.data(), restored.size());
+    return true;
+}
+
+bool MissionCache::itemsMatch(const mavlink_mission_item_int_t* items, size_t count, uint16_t first,
+                              const WGS84CoordInt* coords, size_t pointCount, int32_t tolerance)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t seq = first + i;
+
+        // Пункт 0 (дом) автопилот переписывает сам
+        if (seq == 0)
+            continue;
+        if (seq > pointCount || !itemMatches(items[i], coords[seq - 1], tolerance))
+            return false;
+    }
+    return true;
+}
+
+const std::vector<WGS84CoordInt>& MissionCache::getPoints() const
+{
+    return points;
+}
+
+uint32_t MissionCache::getHash() const
+{
+    return hash;
+}
+
+size_t MissionCache::size() const
+{
+    return points.size();
+}
@@ -0,0 +1,241 @@
+#include "MissionDownloader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+MissionDownloader::MissionDownloader(Sender send, const MissionTransferSettings& settings)
+    : send(std::move(send)), settings(settings)
+{
+}
+
+void MissionDownloader::begin(Clock::time_point now)
+{
+    if (state != State::Idle)
+        cancel(now);
+
+    promise = std::promise<MissionDownloadResult>();
+    result = MissionDownloadResult();
+
+    retries = 0;
+    started = now;
+    retryAt = now + settings.retryTimeout;
+    deadline = now + settings.deadline;
+}
+
+std::future<MissionDownloadResult> MissionDownloader::start(Clock::time_point now)
+{
+    begin(now);
+    listed = true;
+    state = State::WaitingCount;
+
+    mavlink_message_t msg;
+    mavlink_msg_mission_request_list_pack(settings.systemId, settings.componentId, &msg,
+                                          settings.targetSystem, settings.targetComponent, MAV_MISSION_TYPE_MISSION);
+    send(msg);
+
+    return promise.get_future();
+}
+
+std::future<MissionDownloadResult> MissionDownloader::startRange(uint16_t first, uint16_t last, Clock::time_point now)
+{
+    begin(now);
+    listed = false;
+
+    std::future<MissionDownloadResult> future = promise.get_future();
+
+    firstSeq = first;
+    receive(static_cast<uint16_t>(last - first + 1), now);
+    return future;
+}
+
+void MissionDownloader::receive(uint16_t count, Clock::time_point now)
+{
+    lastSeq = static_cast<uint16_t>(firstSeq + count - 1);
+    have.assign(count, false);
+    missing = count;
+    result.first = firstSeq;
+    result.items.assign(count, mavlink_mission_item_int_t());
+    state = State::Receiving;
+
+    if (count == 0)
+    {
+        finish(true, false, now);
+        return;
+    }
+
+    // Окно запросов: следующий пункт запрашивается по приходу очередного
+    nextRequest = firstSeq;
+    while (nextRequest <= lastSeq && nextRequest - firstSeq < settings.readbackWindow)
+        request(static_cast<uint16_t>(nextRequest++));
+
+    retryAt = now + settings.retryTimeout;
+}
+
+void MissionDownloader::request(uint16_t seq)
+{
+    mavlink_message_t msg;
+    mavlink_msg_mission_request_int_pack(settings.systemId, settings.componentId, &msg,
+                                         settings.targetSystem, settings.targetComponent, seq, MAV_MISSION_TYPE_MISSION);
+    send(msg);
+}
+
+void MissionDownloader::onItem(const mavlink_mission_item_int_t& item, Clock::time_point now)
+{
+    if (item.seq < firstSeq || item.seq > lastSeq || have[item.seq - firstSeq])
+        return;
+
+    have[item.seq - firstSeq] = true;
+    result.items[item.seq - firstSeq] = item;
+    missing--;
+
+    retries = 0;
+    retryAt = now + settings.retryTimeout;
+
+    if (nextRequest <= lastSeq)
+        request(static_cast<uint16_t>(nextRequest++));
+
+    if (missing == 0)
+        finish(true, false, now);
+}
+
+void MissionDownloader::handleMessage(const mavlink_message_t& msg, Clock::time_point now)
+{
+    mavlinkDispatchTo(*this, msg, now);
+}
+
+bool MissionDownloader::accepts(const mavlink_frame_view_t& frame, uint8_t targetSystem,
+                                uint8_t targetComponent) const
+{
+    return state != State::Idle && frame.sysid == settings.targetSystem && targetSystem == settings.systemId
+        && (targetComponent == settings.componentId || targetComponent == MAV_COMP_ID_ALL);
+}
+
+void MissionDownloader::handle(const mavlink_mission_count_t& count, const mavlink_frame_view_t& frame, Clock::time_point now)
+{
+    if (accepts(frame, count.target_system, count.target_component) && state == State::WaitingCount
+        && count.mission_type == MAV_MISSION_TYPE_MISSION)
+    {
+        firstSeq = 0;
+        receive(count.count, now);
+    }
+}
+
+void MissionDownloader::handle(const mavlink_mission_item_int_t& item, const mavlink_frame_view_t& frame,
+                               Clock::time_point now)
+{
+    if (accepts(frame, item.target_system, item.target_component) && state == State::Receiving
+        && item.mission_type == MAV_MISSION_TYPE_MISSION)
+        onItem(item, now);
+}
+
+void MissionDownloader::handle(const mavlink_mission_item_t& wp, const mavlink_frame_view_t& frame, Clock::time_point now)
+{
+    if (!accepts(frame, wp.target_system, wp.target_component) || state != State::Receiving
+        || wp.mission_type != MAV_MISSION_TYPE_MISSION)
+        return;
+
+    mavlink_mission_item_int_t item;
+    item.param1 = wp.param1;
+    item.param2 = wp.param2;
+    item.param3 = wp.param3;
+    item.param4 = wp.param4;
+    item.x = static_cast<int32_t>(std::lround(wp.x * 1e7));
+    item.y = static_cast<int32_t>(std::lround(wp.y * 1e7));
+    item.z = wp.z;
+    item.seq = wp.seq;
+    item.command = wp.command;
+    item.target_system = wp.target_system;
+    item.target_component = wp.target_component;
+    item.frame = wp.frame;
+    item.current = wp.current;
+    item.autocontinue = wp.autocontinue;
+    item.mission_type = wp.mission_type;
+    onItem(item, now);
+}
+
+void MissionDownloader::handle(const mavlink_mission_ack_t& ack, const mavlink_frame_view_t& frame, Clock::time_point now)
+{
+    if (accepts(frame, ack.target_system, ack.target_component) && ack.mission_type == MAV_MISSION_TYPE_MISSION
+        && ack.type != MAV_MISSION_ACCEPTED)
+    {
+        std::cerr << "Mission download refused, type=" << static_cast<int>(ack.type) << std::endl;
+        finish(false, false, now);
+    }
+}
+
+void MissionDownloader::poll(Clock::time_point now)
+{
+    if (state == State::Idle)
+        return;
+
+    if (now >= deadline || (now >= retryAt && retries >= settings.maxRetries))
+    {
+        std::cerr << "Mission download timeout" << std::endl;
+        finish(false, true, now);
+        return;
+    }
+
+    if (now < retryAt)
+        return;
+
+    retries++;
+    result.retransmits++;
+    retryAt = now + settings.retryTimeout;
+
+    if (state == State::WaitingCount)
+    {
+        mavlink_message_t msg;
+        mavlink_msg_mission_request_list_pack(settings.systemId, settings.componentId, &msg,
+                                              settings.targetSystem, settings.targetComponent, MAV_MISSION_TYPE_MISSION);
+        send(msg);
+        return;
+    }
+
+    // Повторяются все запрошенные, но не полученные пункты окна
+    for (uint32_t seq = firstSeq; seq < nextRequest; ++seq)
+    {
+        if (!have[seq - firstSeq])
+            request(static_cast<uint16_t>(seq));
+    }
+}
+
+void MissionDownloader::cancel(Clock::time_point now)
+{
+    if (state != State::Idle)
+        finish(false, false, now);
+}
+
+void MissionDownloader::finish(bool complete, bool timedOut, Clock::time_point now)
+{
+    // Транзакцию, начатую MISSION_REQUEST_LIST, автопилот закрывает по нашему MISSION_ACK
+    if (listed && state != State::Idle)
+    {
+        mavlink_message_t msg;
+        mavlink_msg_mission_ack_pack(settings.systemId, settings.componentId, &msg, settings.targetSystem,
+                                     settings.targetComponent,
+                                     complete ? MAV_MISSION_ACCEPTED : MAV_MISSION_OPERATION_CANCELLED,
+                                     MAV_MISSION_TYPE_MISSION);
+        send(msg);
+    }
+
+    state = State::Idle;
+
+    result.complete = complete;
+    result.timedOut = timedOut;
+    result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - started);
+    if (!complete)
+        result.items.clear();
+
+    promise.set_value(result);
+}
+
+bool MissionDownloader::active() const
+{
+    return state != State::Idle;
+}
+
+MissionDownloader::Clock::time_point MissionDownloader::nextWakeup() const
+{
+    return std::min(retryAt, deadline);
+}
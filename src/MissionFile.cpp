@@ -0,0 +1,33 @@
+#include "MissionFile.h"
+
+void encodeMissionFile(const mavlink_mission_item_int_t* items, size_t count, std::vector<uint8_t>& file)
+{
+    MissionFileHeader header;
+    header.numItems = static_cast<uint16_t>(count);
+
+    file.resize(wireSize<MissionFileHeader>() + count * wireSize<mavlink_mission_item_int_t>());
+
+    uint8_t* out = wireEncode(header, file.data());
+    for (size_t i = 0; i < count; ++i)
+        out = wireEncode(items[i], out);
+}
+
+bool decodeMissionFile(const uint8_t* data, size_t size, std::vector<mavlink_mission_item_int_t>& items)
+{
+    items.clear();
+    if (size < wireSize<MissionFileHeader>())
+        return false;
+
+    MissionFileHeader header;
+    const uint8_t* in = wireDecode(header, data);
+
+    if (header.magic != MISSION_FILE_MAGIC || header.dataType != MAV_MISSION_TYPE_MISSION)
+        return false;
+    if (size < wireSize<MissionFileHeader>() + header.numItems * wireSize<mavlink_mission_item_int_t>())
+        return false;
+
+    items.resize(header.numItems);
+    for (mavlink_mission_item_int_t& item : items)
+        in = wireDecode(item, in);
+    return true;
+}
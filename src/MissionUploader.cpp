@@ -0,0 +1,207 @@
+#include "MissionUploader.h"
+
+#include <algorithm>
+#include <iostream>
+
+MissionUploader::MissionUploader(Sender send, const MissionTransferSettings& settings)
+    : send(std::move(send)), settings(settings)
+{
+}
+
+std::future<MissionUploadResult> MissionUploader::start(uint16_t count, ItemSource source, Clock::time_point now)
+{
+    mavlink_message_t msg;
+    mavlink_msg_mission_count_pack(settings.systemId, settings.componentId, &msg,
+                                   settings.targetSystem, settings.targetComponent, count, MAV_MISSION_TYPE_MISSION);
+
+    // Пустая миссия: запросов не будет, автопилот сразу отвечает MISSION_ACK
+    if (count == 0)
+        return begin(msg, 1, 0, std::move(source), now);
+
+    return begin(msg, 0, static_cast<uint16_t>(count - 1), std::move(source), now);
+}
+
+std::future<MissionUploadResult> MissionUploader::startPartial(uint16_t first, uint16_t last, ItemSource source,
+                                                                Clock::time_point now)
+{
+    mavlink_message_t msg;
+    mavlink_msg_mission_write_partial_list_pack(settings.systemId, settings.componentId, &msg, settings.targetSystem,
+                                                settings.targetComponent, first, last, MAV_MISSION_TYPE_MISSION);
+
+    return begin(msg, first, last, std::move(source), now);
+}
+
+std::future<MissionUploadResult> MissionUploader::begin(const mavlink_message_t& announce, uint16_t first, uint16_t last,
+                                                         ItemSource source, Clock::time_point now)
+{
+    if (state != State::Idle)
+        cancel(now);
+
+    promise = std::promise<MissionUploadResult>();
+    result = MissionUploadResult();
+
+    itemAt = std::move(source);
+    firstSeq = first;
+    lastSeq = last;
+    sent.assign(last >= first ? last - first + 1 : 0, false);
+    retries = 0;
+    started = now;
+    deadline = now + settings.deadline;
+    state = State::SendingCount;
+
+    transmit(announce, now);
+
+    return promise.get_future();
+}
+
+void MissionUploader::onComplete(Callback cb)
+{
+    callback = std::move(cb);
+}
+
+void MissionUploader::transmit(const mavlink_message_t& msg, Clock::time_point now)
+{
+    lastMessage = msg;
+    retryAt = now + settings.retryTimeout;
+    send(msg);
+}
+
+void MissionUploader::onRequest(uint16_t seq, MissionItemFormat format, Clock::time_point now)
+{
+    mavlink_message_t msg;
+    if (seq < firstSeq || seq > lastSeq || sent.empty() || !itemAt(seq, format, msg))
+    {
+        // Чужой или испорченный запрос: ждём правильный, таймер повтора не трогаем
+        result.rejected++;
+        std::cerr << "Mission request out of range: seq=" << seq << " expected " << firstSeq << ".." << lastSeq << std::endl;
+        return;
+    }
+
+    if (sent[seq - firstSeq])
+        result.duplicates++;
+    sent[seq - firstSeq] = true;
+
+    if (format == MissionItemFormat::Float)
+        result.floatItems++;
+
+    // Автопилот ответил - счётчик повторов начинается заново
+    retries = 0;
+    state = State::SendingItems;
+    transmit(msg, now);
+}
+
+void MissionUploader::handleMessage(const mavlink_message_t& msg, Clock::time_point now)
+{
+    mavlinkDispatchTo(*this, msg, now);
+}
+
+bool MissionUploader::accepts(const mavlink_frame_view_t& frame, uint8_t targetSystem,
+                              uint8_t targetComponent) const
+{
+    return state != State::Idle && frame.sysid == settings.targetSystem && targetSystem == settings.systemId
+        && (targetComponent == settings.componentId || targetComponent == MAV_COMP_ID_ALL);
+}
+
+void MissionUploader::handle(const mavlink_mission_request_t& req, const mavlink_frame_view_t& frame, Clock::time_point now)
+{
+    if (accepts(frame, req.target_system, req.target_component) && req.mission_type == MAV_MISSION_TYPE_MISSION)
+        onRequest(req.seq, MissionItemFormat::Float, now);
+}
+
+void MissionUploader::handle(const mavlink_mission_request_int_t& req, const mavlink_frame_view_t& frame,
+                             Clock::time_point now)
+{
+    if (accepts(frame, req.target_system, req.target_component) && req.mission_type == MAV_MISSION_TYPE_MISSION)
+        onRequest(req.seq, MissionItemFormat::Int, now);
+}
+
+void MissionUploader::handle(const mavlink_mission_ack_t& ack, const mavlink_frame_view_t& frame, Clock::time_point now)
+{
+    if (accepts(frame, ack.target_system, ack.target_component) && ack.mission_type == MAV_MISSION_TYPE_MISSION)
+        finish(ack.type, false, now);
+}
+
+void MissionUploader::poll(Clock::time_point now)
+{
+    if (state == State::Idle)
+        return;
+
+    if (now >= deadline)
+    {
+        std::cerr << "Mission upload deadline exceeded" << std::endl;
+        abort(true, now);
+        return;
+    }
+
+    if (now < retryAt)
+        return;
+
+    if (retries >= settings.maxRetries)
+    {
+        std::cerr << "Mission upload: no response after " << retries << " retries" << std::endl;
+        abort(true, now);
+        return;
+    }
+
+    retries++;
+    result.retransmits++;
+    transmit(lastMessage, now);
+}
+
+void MissionUploader::cancel(Clock::time_point now)
+{
+    if (state != State::Idle)
+        abort(false, now);
+}
+
+void MissionUploader::abort(bool timedOut, Clock::time_point now)
+{
+    // Автопилот тоже прекращает приём, иначе он ждёт оставшиеся пункты
+    mavlink_message_t msg;
+    mavlink_msg_mission_ack_pack(settings.systemId, settings.componentId, &msg, settings.targetSystem,
+                                 settings.targetComponent, MAV_MISSION_OPERATION_CANCELLED, MAV_MISSION_TYPE_MISSION);
+    send(msg);
+
+    finish(MAV_MISSION_OPERATION_CANCELLED, timedOut, now);
+}
+
+void MissionUploader::finish(uint8_t ackType, bool timedOut, Clock::time_point now)
+{
+    state = State::Idle;
+    itemAt = nullptr;
+
+    result.accepted = ackType == MAV_MISSION_ACCEPTED;
+    result.timedOut = timedOut;
+    result.ackType = ackType;
+    result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - started);
+
+    totals.uploads++;
+    totals.accepted += result.accepted;
+    totals.retransmits += result.retransmits;
+    totals.totalDuration += result.duration;
+    totals.maxDuration = std::max(totals.maxDuration, result.duration);
+
+    if (callback)
+        callback(result);
+    promise.set_value(result);
+}
+
+bool MissionUploader::active() const
+{
+    return state != State::Idle;
+}
+
+MissionUploader::Clock::time_point MissionUploader::nextWakeup() const
+{
+    return std::min(retryAt, deadline);
+}
+
+const MissionUploadResult& MissionUploader::lastResult() const
+{
+    return result;
+}
+
+const MissionUploadStats& MissionUploader::stats() const
+{
+    return totals;
+}
@@ -36,7 +36,6 @@ WGS84Coord* tryReadCoords(int& count)
 
     file.close();
     remove(filename);
-    std::cout << "Coords sended\n";
 
     return coords;
 }
@@ -56,41 +55,97 @@ bool savePNG(unsigned char *image, int imageSize, const char *filename)
     return file.good();
 }
 
-void sendCoords(InterfaceTCPClient tmp)
+bool tryReadRoute(FlyPlaneData& data)
 {
-    FlyPlaneData Data;
-    WGS84Coord* coords;
+    // Двоичный файл читается прямо из отображённой памяти
+    MappedRouteFile file;
+    if (file.open(ROUTE_STORE_FILE))
+    {
+        file.view().copyTo(data);
+        file.close();
+        remove(ROUTE_STORE_FILE);
+        return true;
+    }
+
     int count;
+    WGS84Coord* coords = tryReadCoords(count);
+    if (coords != nullptr)
+    {
+        data.setCoords(coords, count);
+        delete[] coords;
+        return true;
+    }
+
+    return false;
+}
+
+void sendCoords(InterfaceTCPClient &tmp)
+{
+    FlyPlaneData Data;
+
+    // Новый маршрут подхватывается по событию inotify сразу после записи
+    RouteFileWatcher watcher(".");
+    const char* names[] = { ROUTE_STORE_FILE, "coords.txt" };
     
     while (true)
     {
-        coords = tryReadCoords(count);
-        if (coords != nullptr)
+        if (tryReadRoute(Data))
         {
-            Data.setCoords(coords, count);
-            tmp.sendFlyPlaneData(Data);
+            // Маршруты из близких точек сжимаются разностным кодированием в 3-5 раз
+            Data.setEncodingFlags(ROUTE_FLAG_DELTA_VARINT);
+
+            if (!tmp.waitConnected(std::chrono::seconds(5)) || tmp.sendFlyPlaneData(Data) < 0)
+                std::cerr << "Coords not sent: no connection" << std::endl;
+            else
+                std::cout << "Coords sended\n";
         }
-        count = 0;
 
-        std::this_thread::sleep_for(std::chrono::seconds(3));
+        // Без inotify - прежний опрос раз в 3 секунды
+        if (watcher.wait(names, 2, 3000) < 0 && !watcher.isValid())
+            std::this_thread::sleep_for(std::chrono::seconds(3));
     }
-
-    delete coords;
-    coords = nullptr;
 }
 
-void recvImage(InterfaceTCPServer tmp)
+void recvImage(InterfaceTCPServer &tmp)
 {
+    PayloadProtector& protector = payloadProtector();
+    std::vector<uint8_t> buffer(BUFFER_SIZE);
+    uint32_t expectedSequence = 0;
+
     while (true)
     {
-		uint8_t* buffer = new uint8_t[BUFFER_SIZE]; 
-        auto imageSize = tmp.recvData(buffer);
+        // Кадр: [ImageHeader][защищённое сообщение]
+        uint8_t raw[wireSize<ImageHeader>()];
+        if (tmp.recvExact(raw, sizeof(raw)) < 0)
+            continue;
+
+        ImageHeader header;
+        wireDecode(header, raw);
+
+        uint32_t messageSize = header.size;
+        if (messageSize < protector.overhead() || messageSize > buffer.size())
+        {
+            // Поток рассинхронизирован - начинаем с нового соединения
+            std::cerr << "Image: bad frame length " << messageSize << std::endl;
+            close(tmp.client_fd);
+            tmp.client_fd = -1;
+            continue;
+        }
+
+        if (tmp.recvExact(buffer.data(), messageSize) < 0)
+            continue;
+
+        if (!protector.open(buffer.data(), messageSize))
+        {
+            std::cerr << "Image: authentication failed, frame dropped" << std::endl;
+            continue;
+        }
 
-		if (imageSize > 0)
-		    savePNG(buffer, imageSize, "getted.png");
+        if (header.sequence > expectedSequence && expectedSequence != 0)
+            std::cerr << "Image: " << header.sequence - expectedSequence << " frames lost" << std::endl;
+        expectedSequence = header.sequence + 1;
 
-		delete[] buffer;
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        savePNG(buffer.data() + protector.prefixSize(), messageSize - protector.overhead(), "getted.png");
     }
 }
 
@@ -99,8 +154,8 @@ void PC_func(void)
     InterfaceTCPServer ImageRecv(TEST_IP, TEST_PORT);
     InterfaceTCPClient CoordsSend(TEST_IP, TEST_PORT + 1);
 
-    std::thread sendThread(sendCoords, CoordsSend);
-    std::thread recvThread(recvImage,  ImageRecv);
+    std::thread sendThread(sendCoords, std::ref(CoordsSend));
+    std::thread recvThread(recvImage,  std::ref(ImageRecv));
 
     sendThread.join();
     recvThread.join();
@@ -0,0 +1,296 @@
+#include "PayloadProtection.h"
+#include "FlyDefines.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <string>
+
+XorProtector::XorProtector(const char* key) : key(key)
+{
+}
+
+size_t XorProtector::prefixSize() const
+{
+    return 0;
+}
+
+size_t XorProtector::suffixSize() const
+{
+    return 0;
+}
+
+void XorProtector::apply(unsigned char* data, size_t size, size_t offset) const
+{
+    if (!data || size == 0) return;
+
+    size_t keyLength = strlen(key);
+
+    for (size_t i = 0; i < size; i++)
+        data[i] ^= key[(offset + i) % keyLength];
+}
+
+void XorProtector::seal(unsigned char* message, size_t size)
+{
+    apply(message, size);
+}
+
+bool XorProtector::open(unsigned char* message, size_t messageSize)
+{
+    apply(message, messageSize);
+    return true;
+}
+
+void XorProtector::peek(const unsigned char* message, unsigned char* out, size_t size) const
+{
+    memcpy(out, message, size);
+    apply(out, size);
+}
+
+namespace
+{
+class XorStream : public PayloadStream
+{
+private:
+    const XorProtector& protector;
+    size_t offset = 0;
+
+public:
+    explicit XorStream(const XorProtector& protector) : protector(protector) {}
+
+    void update(unsigned char* data, size_t size) override
+    {
+        protector.apply(data, size, offset);
+        offset += size;
+    }
+
+    bool finish(const unsigned char*) override
+    {
+        return true;
+    }
+};
+
+class AeadStream : public PayloadStream
+{
+private:
+    ChaCha20Poly1305 aead;
+
+public:
+    AeadStream(const uint8_t* key, const unsigned char* nonce)
+    {
+        aead.init(key, nonce);
+    }
+
+    void update(unsigned char* data, size_t size) override
+    {
+        aead.decrypt(data, size);
+    }
+
+    bool finish(const unsigned char* suffix) override
+    {
+        return aead.verify(suffix);
+    }
+};
+}
+
+std::unique_ptr<PayloadStream> XorProtector::openStream(const unsigned char*)
+{
+    return std::unique_ptr<PayloadStream>(new XorStream(*this));
+}
+
+size_t NoKeyProtector::prefixSize() const
+{
+    return 0;
+}
+
+size_t NoKeyProtector::suffixSize() const
+{
+    return 0;
+}
+
+void NoKeyProtector::seal(unsigned char* message, size_t size)
+{
+    memset(message, 0, size);
+}
+
+bool NoKeyProtector::open(unsigned char*, size_t)
+{
+    return false;
+}
+
+void NoKeyProtector::peek(const unsigned char* message, unsigned char* out, size_t size) const
+{
+    memcpy(out, message, size);
+}
+
+namespace
+{
+class RejectingStream : public PayloadStream
+{
+public:
+    void update(unsigned char*, size_t) override {}
+
+    bool finish(const unsigned char*) override
+    {
+        return false;
+    }
+};
+}
+
+std::unique_ptr<PayloadStream> NoKeyProtector::openStream(const unsigned char*)
+{
+    return std::unique_ptr<PayloadStream>(new RejectingStream());
+}
+
+ChaCha20Poly1305Protector::ChaCha20Poly1305Protector(const uint8_t newKey[CHACHA20_KEY_SIZE])
+{
+    memcpy(key, newKey, sizeof(key));
+
+    // Случайная часть nonce делает совпадение nonce между перезапусками практически невозможным
+    std::random_device random;
+    for (size_t i = 0; i < sizeof(noncePrefix); i += 4)
+    {
+        uint32_t value = random();
+        memcpy(noncePrefix + i, &value, 4);
+    }
+}
+
+ChaCha20Poly1305Protector::~ChaCha20Poly1305Protector()
+{
+    volatile uint8_t* p = key;
+    for (size_t i = 0; i < sizeof(key); ++i) p[i] = 0;
+}
+
+std::unique_ptr<ChaCha20Poly1305Protector> ChaCha20Poly1305Protector::fromKeyFile(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return nullptr;
+
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    uint8_t key[CHACHA20_KEY_SIZE];
+    if (content.size() == CHACHA20_KEY_SIZE)
+    {
+        memcpy(key, content.data(), sizeof(key));
+    }
+    else
+    {
+        std::string hex;
+        for (char c : content)
+            if (!isspace(static_cast<unsigned char>(c))) hex += c;
+
+        if (hex.size() != 2 * CHACHA20_KEY_SIZE) {
+            fprintf(stderr, "Invalid key file %s: expected 32 bytes or 64 hex digits\n", path);
+            return nullptr;
+        }
+
+        for (size_t i = 0; i < CHACHA20_KEY_SIZE; ++i)
+        {
+            unsigned int byte;
+            if (sscanf(hex.c_str() + 2 * i, "%2x", &byte) != 1) {
+                fprintf(stderr, "Invalid key file %s: bad hex digit\n", path);
+                return nullptr;
+            }
+            key[i] = static_cast<uint8_t>(byte);
+        }
+    }
+
+    std::unique_ptr<ChaCha20Poly1305Protector> protector(new ChaCha20Poly1305Protector(key));
+    memset(key, 0, sizeof(key));
+    return protector;
+}
+
+size_t ChaCha20Poly1305Protector::prefixSize() const
+{
+    return CHACHA20_NONCE_SIZE;
+}
+
+size_t ChaCha20Poly1305Protector::suffixSize() const
+{
+    return POLY1305_TAG_SIZE;
+}
+
+void ChaCha20Poly1305Protector::seal(unsigned char* message, size_t size)
+{
+    uint32_t sequence = counter++;
+    memcpy(message, noncePrefix, sizeof(noncePrefix));
+    message[8] = static_cast<unsigned char>(sequence);
+    message[9] = static_cast<unsigned char>(sequence >> 8);
+    message[10] = static_cast<unsigned char>(sequence >> 16);
+    message[11] = static_cast<unsigned char>(sequence >> 24);
+
+    ChaCha20Poly1305 aead;
+    aead.init(key, message);
+    aead.encrypt(message + CHACHA20_NONCE_SIZE, size);
+    aead.finish(message + CHACHA20_NONCE_SIZE + size);
+}
+
+bool ChaCha20Poly1305Protector::open(unsigned char* message, size_t messageSize)
+{
+    if (messageSize < overhead()) return false;
+
+    size_t size = messageSize - overhead();
+    unsigned char* data = message + CHACHA20_NONCE_SIZE;
+
+    // Сначала тег, расшифровываем только подлинное сообщение
+    ChaCha20Poly1305 aead;
+    aead.init(key, message);
+    aead.authenticate(data, size);
+    if (!aead.verify(data + size)) return false;
+
+    ChaCha20 cipher;
+    cipher.init(key, message, 1);
+    cipher.process(data, size);
+    return true;
+}
+
+void ChaCha20Poly1305Protector::peek(const unsigned char* message, unsigned char* out, size_t size) const
+{
+    memcpy(out, message + CHACHA20_NONCE_SIZE, size);
+
+    ChaCha20 cipher;
+    cipher.init(key, message, 1);
+    cipher.process(out, size);
+}
+
+std::unique_ptr<PayloadStream> ChaCha20Poly1305Protector::openStream(const unsigned char* prefix)
+{
+    return std::unique_ptr<PayloadStream>(new AeadStream(key, prefix));
+}
+
+static std::mutex protectorMutex;
+static std::unique_ptr<PayloadProtector> currentProtector;
+
+PayloadProtector& payloadProtector()
+{
+    std::lock_guard<std::mutex> lock(protectorMutex);
+
+    if (!currentProtector)
+    {
+        currentProtector = ChaCha20Poly1305Protector::fromKeyFile(PAYLOAD_KEY_FILE);
+        if (currentProtector)
+            printf("Payload protection: ChaCha20-Poly1305 (%s)\n", PAYLOAD_KEY_FILE);
+        else
+        {
+#if PAYLOAD_ALLOW_XOR_FALLBACK
+            fprintf(stderr, "Payload protection: %s not found, falling back to XOR without integrity check\n", PAYLOAD_KEY_FILE);
+            currentProtector.reset(new XorProtector());
+#else
+            fprintf(stderr, "Payload protection: %s not found, routes and frames are refused\n", PAYLOAD_KEY_FILE);
+            currentProtector.reset(new NoKeyProtector());
+#endif
+        }
+    }
+
+    return *currentProtector;
+}
+
+void setPayloadProtector(std::unique_ptr<PayloadProtector> protector)
+{
+    std::lock_guard<std::mutex> lock(protectorMutex);
+    currentProtector = std::move(protector);
+}
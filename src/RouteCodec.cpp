@@ -0,0 +1,180 @@
+#include "RouteCodec.h"
+
+#include <cstring>
+
+static inline uint32_t zigzag(uint32_t delta)
+{
+    return (delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(delta) >> 31);
+}
+
+static inline uint32_t unzigzag(uint32_t value)
+{
+    return (value >> 1) ^ (0u - (value & 1));
+}
+
+static inline size_t varintSize(uint32_t value)
+{
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+static inline unsigned char* writeVarint(uint32_t value, unsigned char* out)
+{
+    while (value >= 0x80) {
+        *out++ = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<unsigned char>(value);
+    return out;
+}
+
+// Разности считаются по модулю 2^32: переход долготы через ±180 не переполняет int32
+static inline uint32_t delta(int32_t current, int32_t previous)
+{
+    return zigzag(static_cast<uint32_t>(current) - static_cast<uint32_t>(previous));
+}
+
+static inline int32_t applyDelta(int32_t previous, uint32_t value)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(previous) + unzigzag(value));
+}
+
+// Чтение varint. Если впереди есть 8 байт, конец числа ищется сразу во всём слове
+// (SWAR): нулевой старший бит - последний байт, 7-битные группы собираются сдвигами.
+static inline const unsigned char* readVarint(const unsigned char* p, const unsigned char* end, uint32_t& value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (end - p >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+
+        uint64_t stops = ~word & 0x8080808080808080ull;
+        int length = (__builtin_ctzll(stops | (1ull << 63)) >> 3) + 1;
+        if (length > 5) return nullptr;
+
+        uint64_t x = word & (~0ull >> (64 - 8 * length));
+        value = static_cast<uint32_t>((x & 0x7f) | ((x >> 1) & 0x3f80) | ((x >> 2) & 0x1fc000) |
+                                      ((x >> 3) & 0xfe00000) | ((x >> 4) & 0xf0000000));
+        return p + length;
+    }
+#endif
+
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7)
+    {
+        unsigned char byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return p;
+    }
+
+    return nullptr;
+}
+
+bool checkRouteHeader(const RouteHeader& header)
+{
+    if (header.pointCount > header.payloadSize || (header.flags & ~ROUTE_FLAG_DELTA_VARINT) != 0)
+        return false;
+
+    return (header.flags & ROUTE_FLAG_DELTA_VARINT) ||
+           header.payloadSize == static_cast<uint64_t>(header.pointCount) * ROUTE_POINT_SIZE;
+}
+
+size_t routePayloadSize(const WGS84CoordInt* points, int count, uint8_t flags)
+{
+    if (count <= 0) return 0;
+    if (!(flags & ROUTE_FLAG_DELTA_VARINT)) return static_cast<size_t>(count) * ROUTE_POINT_SIZE;
+
+    size_t size = ROUTE_POINT_SIZE;
+    for (int i = 1; i < count; ++i)
+    {
+        size += varintSize(delta(points[i].lat, points[i - 1].lat));
+        size += varintSize(delta(points[i].lon, points[i - 1].lon));
+        size += varintSize(delta(points[i].alt, points[i - 1].alt));
+    }
+    return size;
+}
+
+unsigned char* encodeRoutePayload(const WGS84CoordInt* points, int count, uint8_t flags, unsigned char* out)
+{
+    if (count <= 0) return out;
+
+    encodeRoutePoint(points[0], out);
+    out += ROUTE_POINT_SIZE;
+
+    for (int i = 1; i < count; ++i)
+    {
+        if (flags & ROUTE_FLAG_DELTA_VARINT)
+        {
+            out = writeVarint(delta(points[i].lat, points[i - 1].lat), out);
+            out = writeVarint(delta(points[i].lon, points[i - 1].lon), out);
+            out = writeVarint(delta(points[i].alt, points[i - 1].alt), out);
+        }
+        else
+        {
+            encodeRoutePoint(points[i], out);
+            out += ROUTE_POINT_SIZE;
+        }
+    }
+
+    return out;
+}
+
+RoutePointReader::RoutePointReader(const unsigned char* payload, size_t size, uint32_t count, uint8_t flags)
+    : ptr(payload), end(payload + size), flags(flags), count(count)
+{
+}
+
+bool RoutePointReader::next(WGS84CoordInt& point)
+{
+    if (ptr == nullptr || index >= count) return false;
+
+    if (index == 0 || !(flags & ROUTE_FLAG_DELTA_VARINT))
+    {
+        if (end - ptr < ROUTE_POINT_SIZE) {
+            ptr = nullptr;
+            return false;
+        }
+        last = decodeRoutePoint(ptr);
+        ptr += ROUTE_POINT_SIZE;
+    }
+    else
+    {
+        uint32_t dLat, dLon, dAlt;
+        if (!(ptr = readVarint(ptr, end, dLat)) || !(ptr = readVarint(ptr, end, dLon)) || !(ptr = readVarint(ptr, end, dAlt)))
+            return false;
+
+        last.lat = applyDelta(last.lat, dLat);
+        last.lon = applyDelta(last.lon, dLon);
+        last.alt = applyDelta(last.alt, dAlt);
+    }
+
+    point = last;
+    ++index;
+    return true;
+}
+
+bool RoutePointReader::failed() const
+{
+    return ptr == nullptr;
+}
+
+uint32_t RoutePointReader::position() const
+{
+    return index;
+}
+
+void RoutePointReader::resume(const unsigned char* payload, size_t size)
+{
+    ptr = payload;
+    end = payload + size;
+}
+
+const unsigned char* RoutePointReader::current() const
+{
+    return ptr;
+}
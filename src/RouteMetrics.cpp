@@ -0,0 +1,130 @@
+#include "RouteMetrics.h"
+#include "GeodesyKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef HAVE_AVX2_KERNELS
+static bool hasAVX2()
+{
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+void RouteSoA::assign(const WGS84CoordInt* points, int count)
+{
+    const double toRad = M_PI / 180.0 * 1e-7;
+
+    lat.resize(count);
+    lon.resize(count);
+    alt.resize(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        lat[i] = points[i].lat * toRad;
+        lon[i] = points[i].lon * toRad;
+        alt[i] = points[i].alt * 1e-3;
+    }
+}
+
+void RouteSoA::assign(const FlyPlaneData& route)
+{
+    assign(route.getPoints(), route.getPointCount());
+}
+
+size_t RouteSoA::size() const
+{
+    return lat.size();
+}
+
+static void scalarLeg(const RouteSoA& route, size_t i, double& distance, double& bearing)
+{
+    double dLat = route.lat[i + 1] - route.lat[i];
+    double dLon = std::remainder(route.lon[i + 1] - route.lon[i], 2 * M_PI);
+    double c1 = std::cos(route.lat[i]), c2 = std::cos(route.lat[i + 1]);
+
+    double a = std::sin(dLat / 2) * std::sin(dLat / 2) + c1 * c2 * std::sin(dLon / 2) * std::sin(dLon / 2);
+    a = std::min(a, 1.0);
+    distance = 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a)) * GEODESY_EARTH_RADIUS_M;
+
+    double y = std::sin(dLon) * c2;
+    double x = c1 * std::sin(route.lat[i + 1]) - std::sin(route.lat[i]) * c2 * std::cos(dLon);
+    bearing = std::atan2(y, x) * (180.0 / M_PI);
+    if (bearing < 0) bearing += 360.0;
+}
+
+// Вертикальная часть и итоги одинаковы для обоих вариантов
+static void finishMetrics(const RouteSoA& route, double speed, RouteMetrics& metrics)
+{
+    size_t legs = metrics.legLength.size();
+    metrics.climbRate.resize(legs);
+    metrics.totalDistance = metrics.flightTime = 0;
+    metrics.maxClimbRate = metrics.maxDescentRate = 0;
+
+    for (size_t i = 0; i < legs; ++i)
+    {
+        double horizontal = metrics.legLength[i];
+        double vertical = route.alt[i + 1] - route.alt[i];
+        double time = std::sqrt(horizontal * horizontal + vertical * vertical) / speed;
+
+        metrics.climbRate[i] = time > 0 ? vertical / time : 0;
+        metrics.totalDistance += horizontal;
+        metrics.flightTime += time;
+        metrics.maxClimbRate = std::max(metrics.maxClimbRate, metrics.climbRate[i]);
+        metrics.maxDescentRate = std::max(metrics.maxDescentRate, -metrics.climbRate[i]);
+    }
+}
+
+void computeRouteMetricsScalar(const RouteSoA& route, double speed, RouteMetrics& metrics)
+{
+    size_t legs = route.size() > 1 ? route.size() - 1 : 0;
+    metrics.legLength.resize(legs);
+    metrics.bearing.resize(legs);
+
+    for (size_t i = 0; i < legs; ++i)
+        scalarLeg(route, i, metrics.legLength[i], metrics.bearing[i]);
+
+    finishMetrics(route, speed, metrics);
+}
+
+void computeRouteMetrics(const RouteSoA& route, double speed, RouteMetrics& metrics)
+{
+    size_t count = route.size();
+    size_t legs = count > 1 ? count - 1 : 0;
+    metrics.legLength.resize(legs);
+    metrics.bearing.resize(legs);
+
+    const double* lat = route.lat.data();
+    const double* lon = route.lon.data();
+    std::vector<double> sinLat(count), cosLat(count);
+
+    size_t i = 0;
+#ifdef HAVE_AVX2_KERNELS
+    if (hasAVX2())
+        for (; i + 4 <= count; i += 4)
+            geodesyPoints4(lat + i, sinLat.data() + i, cosLat.data() + i);
+#endif
+    for (; i + 2 <= count; i += 2)
+        geodesyPointsV<f64x2>(lat + i, sinLat.data() + i, cosLat.data() + i);
+    for (; i < count; ++i) {
+        sinLat[i] = std::sin(lat[i]);
+        cosLat[i] = std::cos(lat[i]);
+    }
+
+    // Участок i читает точки i и i + 1, поэтому векторный проход идёт до legs
+    i = 0;
+#ifdef HAVE_AVX2_KERNELS
+    if (hasAVX2())
+        for (; i + 4 <= legs; i += 4)
+            geodesyLegs4(lat + i, lon + i, sinLat.data() + i, cosLat.data() + i,
+                         metrics.legLength.data() + i, metrics.bearing.data() + i);
+#endif
+    for (; i + 2 <= legs; i += 2)
+        geodesyLegsV<f64x2>(lat + i, lon + i, sinLat.data() + i, cosLat.data() + i,
+                            metrics.legLength.data() + i, metrics.bearing.data() + i);
+    for (; i < legs; ++i)
+        scalarLeg(route, i, metrics.legLength[i], metrics.bearing[i]);
+
+    finishMetrics(route, speed, metrics);
+}
@@ -0,0 +1,188 @@
+#include "RouteSimplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace
+{
+const double EARTH_RADIUS_M = 6371008.8;
+
+struct LocalPoint
+{
+    double x, y, z;
+};
+
+// Локальная равнопромежуточная проекция вокруг первой точки: для маршрутов в десятки
+// километров погрешность много меньше допуска
+std::vector<LocalPoint> toLocal(const WGS84CoordInt* points, int count)
+{
+    std::vector<LocalPoint> local(count);
+    if (count == 0) return local;
+
+    const double toRad = M_PI / 180.0 * 1e-7;
+    double cosLat = std::cos(points[0].lat * toRad);
+
+    for (int i = 0; i < count; ++i)
+    {
+        // Разность по модулю 2^32, как в RouteCodec, чтобы не ломаться на ±180
+        double dLon = static_cast<int32_t>(static_cast<uint32_t>(points[i].lon) - static_cast<uint32_t>(points[0].lon));
+        local[i].x = dLon * toRad * cosLat * EARTH_RADIUS_M;
+        local[i].y = (static_cast<double>(points[i].lat) - points[0].lat) * toRad * EARTH_RADIUS_M;
+        local[i].z = points[i].alt * 1e-3;
+    }
+
+    return local;
+}
+
+// Расстояние от p до отрезка ab в пространстве
+double segmentDistance(const LocalPoint& p, const LocalPoint& a, const LocalPoint& b)
+{
+    double dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+    double px = p.x - a.x, py = p.y - a.y, pz = p.z - a.z;
+
+    double length2 = dx * dx + dy * dy + dz * dz;
+    double t = length2 > 0 ? (px * dx + py * dy + pz * dz) / length2 : 0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+
+    px -= t * dx;
+    py -= t * dy;
+    pz -= t * dz;
+    return std::sqrt(px * px + py * py + pz * pz);
+}
+
+// Удвоенная площадь треугольника abc
+double triangleArea(const LocalPoint& a, const LocalPoint& b, const LocalPoint& c)
+{
+    double ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+    double vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+
+    double cx = uy * vz - uz * vy;
+    double cy = uz * vx - ux * vz;
+    double cz = ux * vy - uy * vx;
+    return std::sqrt(cx * cx + cy * cy + cz * cz);
+}
+
+// Рекурсия заменена стеком: глубина на длинном маршруте может достигать числа точек
+double douglasPeucker(const std::vector<LocalPoint>& local, double tolerance, std::vector<bool>& keep)
+{
+    double maxDeviation = 0;
+    std::vector<std::pair<int, int>> stack;
+    stack.emplace_back(0, static_cast<int>(local.size()) - 1);
+
+    while (!stack.empty())
+    {
+        int first = stack.back().first, last = stack.back().second;
+        stack.pop_back();
+
+        double farthest = 0;
+        int index = -1;
+        for (int i = first + 1; i < last; ++i)
+        {
+            double distance = segmentDistance(local[i], local[first], local[last]);
+            if (distance > farthest) {
+                farthest = distance;
+                index = i;
+            }
+        }
+
+        if (index < 0) continue;
+
+        if (farthest > tolerance)
+        {
+            keep[index] = true;
+            stack.emplace_back(first, index);
+            stack.emplace_back(index, last);
+        }
+        else if (farthest > maxDeviation)
+            maxDeviation = farthest;
+    }
+
+    return maxDeviation;
+}
+
+// Точки удаляются в порядке возрастания площади треугольника с соседями, пока все
+// удалённые точки остаются в пределах допуска от заменившего их отрезка
+double visvalingamWhyatt(const std::vector<LocalPoint>& local, double tolerance, std::vector<bool>& keep)
+{
+    int count = static_cast<int>(local.size());
+    std::vector<int> prev(count), next(count), version(count, 0);
+    for (int i = 0; i < count; ++i) {
+        prev[i] = i - 1;
+        next[i] = i + 1;
+    }
+
+    typedef std::pair<double, std::pair<int, int>> Entry; // площадь, точка, версия
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+
+    auto push = [&](int i) {
+        if (i <= 0 || i >= count - 1) return;
+        heap.push(Entry(triangleArea(local[prev[i]], local[i], local[next[i]]), std::make_pair(i, ++version[i])));
+    };
+
+    // Наибольшее отклонение от отрезка prev-next всех точек между ними, включая уже удалённые
+    auto deviation = [&](int i) {
+        double worst = 0;
+        for (int j = prev[i] + 1; j < next[i]; ++j)
+            worst = std::max(worst, segmentDistance(local[j], local[prev[i]], local[next[i]]));
+        return worst;
+    };
+
+    for (int i = 1; i < count - 1; ++i) push(i);
+
+    double maxDeviation = 0;
+    while (!heap.empty())
+    {
+        int i = heap.top().second.first;
+        int entryVersion = heap.top().second.second;
+        heap.pop();
+
+        if (!keep[i] || entryVersion != version[i]) continue;
+
+        // Точка вернётся в очередь, когда изменится кто-то из соседей
+        double worst = deviation(i);
+        if (worst > tolerance) continue;
+
+        keep[i] = false;
+        maxDeviation = std::max(maxDeviation, worst);
+
+        next[prev[i]] = next[i];
+        prev[next[i]] = prev[i];
+        push(prev[i]);
+        push(next[i]);
+    }
+
+    return maxDeviation;
+}
+}
+
+SimplifyResult simplifyRoute(FlyPlaneData& route, double toleranceM, SimplifyMethod method)
+{
+    SimplifyResult result;
+    int count = route.getPointCount();
+    if (toleranceM <= 0 || count < 3) return result;
+
+    const WGS84CoordInt* points = route.getPoints();
+    std::vector<LocalPoint> local = toLocal(points, count);
+
+    std::vector<bool> keep(count, method == SimplifyMethod::VisvalingamWhyatt);
+    keep[0] = keep[count - 1] = true;
+
+    if (method == SimplifyMethod::DouglasPeucker)
+        result.maxDeviation = douglasPeucker(local, toleranceM, keep);
+    else
+        result.maxDeviation = visvalingamWhyatt(local, toleranceM, keep);
+
+    std::vector<WGS84CoordInt> kept;
+    kept.reserve(count);
+    for (int i = 0; i < count; ++i)
+        if (keep[i]) kept.push_back(points[i]);
+
+    result.removed = count - static_cast<int>(kept.size());
+    if (result.removed > 0)
+        route.setPoints(std::move(kept));
+
+    return result;
+}
@@ -0,0 +1,161 @@
+#include "RouteStore.h"
+#include "RouteCodec.h"
+#include "WireFormat.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+bool writeRouteFile(const char* path, const WGS84CoordInt* points, int count)
+{
+    if (count < 0 || (count > 0 && !points)) return false;
+
+    size_t payloadSize = static_cast<size_t>(count) * ROUTE_POINT_SIZE;
+    std::vector<unsigned char> data(ROUTE_HEADER_SIZE + payloadSize);
+    encodeRoutePayload(points, count, 0, data.data() + ROUTE_HEADER_SIZE);
+
+    RouteHeader header;
+    header.pointCount = static_cast<uint32_t>(count);
+    header.payloadSize = static_cast<uint32_t>(payloadSize);
+    header.crc = crc32(data.data() + ROUTE_HEADER_SIZE, payloadSize);
+    encodeRouteHeader(header, data.data());
+
+    // Временный файл в том же каталоге, иначе rename не атомарен
+    std::string temp = std::string(path) + ".tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("route file open");
+        return false;
+    }
+
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += n;
+    }
+
+    bool ok = written == data.size() && fsync(fd) == 0;
+    ::close(fd);
+
+    if (!ok || rename(temp.c_str(), path) < 0) {
+        perror("route file write");
+        unlink(temp.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+MappedRouteFile::~MappedRouteFile()
+{
+    close();
+}
+
+bool MappedRouteFile::open(const char* path)
+{
+    close();
+
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size < ROUTE_HEADER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    data = mapped;
+    size = info.st_size;
+
+    // Файл читается последовательно один раз
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    if (!routeView.parsePlain(static_cast<const unsigned char*>(data), size)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedRouteFile::close()
+{
+    if (data) munmap(data, size);
+    data = nullptr;
+    size = 0;
+    routeView = FlyPlaneDataView();
+}
+
+const FlyPlaneDataView& MappedRouteFile::view() const
+{
+    return routeView;
+}
+
+RouteFileWatcher::RouteFileWatcher(const char* directory) : directory(directory)
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        perror("inotify_init1");
+        return;
+    }
+
+    // IN_MOVED_TO - атомарная запись через rename, IN_CLOSE_WRITE - запись на месте
+    watchFd = inotify_add_watch(inotifyFd, directory, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watchFd < 0) perror("inotify_add_watch");
+}
+
+RouteFileWatcher::~RouteFileWatcher()
+{
+    if (inotifyFd >= 0) ::close(inotifyFd);
+}
+
+bool RouteFileWatcher::isValid() const
+{
+    return inotifyFd >= 0 && watchFd >= 0;
+}
+
+int RouteFileWatcher::wait(const char* const* names, int count, int timeoutMs)
+{
+    if (!isValid()) return -1;
+
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true)
+    {
+        struct pollfd pfd = { inotifyFd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, timeoutMs);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready <= 0) return -1;
+
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) continue;
+
+        for (char* ptr = buffer; ptr < buffer + length; )
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0) continue;
+            for (int i = 0; i < count; ++i)
+                if (strcmp(event->name, names[i]) == 0) return i;
+        }
+    }
+}
@@ -0,0 +1,242 @@
+#include "RouteStreamDecoder.h"
+#include "FlyDefines.h"
+#include "WireFormat.h"
+
+#include <algorithm>
+#include <cstring>
+
+RouteStreamDecoder::RouteStreamDecoder(FlyPlaneData& route, PayloadProtector& protector)
+    : route(route), protector(protector)
+{
+    route.clear();
+
+    if (protector.prefixSize() == 0)
+    {
+        stream = protector.openStream(nullptr);
+        stage = Stage::Header;
+    }
+}
+
+size_t RouteStreamDecoder::gather(unsigned char* data, size_t size, size_t target, bool decrypt)
+{
+    size_t n = std::min(size, target - scratch.size());
+    if (decrypt) stream->update(data, n);
+    scratch.insert(scratch.end(), data, data + n);
+    return n;
+}
+
+long RouteStreamDecoder::feed(unsigned char* data, size_t size)
+{
+    if (stage == Stage::Failed) return -1;
+
+    size_t used = 0;
+    while (used < size && stage != Stage::Done)
+    {
+        unsigned char* ptr = data + used;
+        size_t available = size - used;
+
+        switch (stage)
+        {
+        case Stage::Prefix:
+            used += gather(ptr, available, protector.prefixSize(), false);
+            if (scratch.size() == protector.prefixSize())
+            {
+                stream = protector.openStream(scratch.data());
+                scratch.clear();
+                stage = Stage::Header;
+            }
+            break;
+
+        case Stage::Header:
+            used += gather(ptr, available, headerNeed, true);
+            if (scratch.size() == headerNeed && !parseHeader())
+                return fail();
+            break;
+
+        case Stage::Payload:
+        {
+            size_t n = std::min(available, payloadLeft);
+            stream->update(ptr, n);
+            if (!legacy) crc = crc32Update(crc, ptr, n);
+
+            payloadLeft -= n;
+            used += n;
+            if (!decodePayload(ptr, n, payloadLeft == 0) || (payloadLeft == 0 && !finishPayload()))
+                return fail();
+            break;
+        }
+
+        case Stage::Suffix:
+            used += gather(ptr, available, protector.suffixSize(), false);
+            if (scratch.size() == protector.suffixSize())
+            {
+                if (!stream->finish(scratch.data())) return fail();
+                stage = Stage::Done;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return static_cast<long>(used);
+}
+
+bool RouteStreamDecoder::parseHeader()
+{
+    // Первые 4 байта отличают формат v1 от устаревшего
+    if (scratch.size() == sizeof(int32_t))
+    {
+        if (getLE32(scratch.data()) == ROUTE_MAGIC)
+        {
+            headerNeed = ROUTE_HEADER_SIZE;
+            return true;
+        }
+
+        int32_t count;
+        memcpy(&count, scratch.data(), sizeof(count));
+        if (count < 0 || count > ROUTE_MAX_POINTS) return false;
+
+        legacy = true;
+        pointCount = static_cast<uint32_t>(count);
+        return startPayload(static_cast<size_t>(count) * 3 * sizeof(float));
+    }
+
+    // Заголовок более новой версии может быть длиннее
+    wireDecode(header, scratch.data());
+    if (header.headerSize > scratch.size())
+    {
+        headerNeed = header.headerSize;
+        return true;
+    }
+
+    if (!decodeRouteHeader(scratch.data(), scratch.size(), header) || !checkRouteHeader(header) ||
+        header.pointCount > ROUTE_MAX_POINTS)
+        return false;
+
+    pointCount = header.pointCount;
+    route.setEncodingFlags(header.flags);
+    reader = RoutePointReader(nullptr, 0, pointCount, header.flags);
+    return startPayload(header.payloadSize);
+}
+
+bool RouteStreamDecoder::startPayload(size_t payloadSize)
+{
+    totalSize = protector.prefixSize() + scratch.size() + payloadSize + protector.suffixSize();
+    scratch.clear();
+
+    route.reserve(pointCount);
+    payloadLeft = payloadSize;
+    stage = Stage::Payload;
+
+    return payloadLeft > 0 || finishPayload();
+}
+
+bool RouteStreamDecoder::nextPoint(const unsigned char*& ptr, const unsigned char* end)
+{
+    WGS84CoordInt point;
+
+    if (legacy)
+    {
+        float values[3];
+        if (static_cast<size_t>(end - ptr) < sizeof(values)) return false;
+        memcpy(values, ptr, sizeof(values));
+        ptr += sizeof(values);
+        point = WGS84CoordInt::fromCoord(WGS84Coord(values[0], values[1], values[2]));
+    }
+    else
+    {
+        reader.resume(ptr, end - ptr);
+        if (!reader.next(point)) return false;
+        ptr = reader.current();
+    }
+
+    route.append(point);
+    return true;
+}
+
+bool RouteStreamDecoder::decodePayload(const unsigned char* data, size_t size, bool last)
+{
+    const unsigned char* ptr = data;
+    const unsigned char* end = data + size;
+
+    // Дописываем начало фрагмента к перенесённому хвосту и дочитываем точки, начатые в нём
+    if (carried > 0)
+    {
+        size_t take = std::min(sizeof(carry) - carried, size);
+        memcpy(carry + carried, data, take);
+        size_t window = carried + take;
+        bool complete = last && take == size;
+
+        const unsigned char* pos = carry;
+        while (pos < carry + carried && static_cast<uint32_t>(route.getPointCount()) < pointCount)
+        {
+            size_t left = carry + window - pos;
+            if (left < ROUTE_MAX_POINT_SIZE && !complete)
+            {
+                memmove(carry, pos, left);
+                carried = left;
+                return true;
+            }
+
+            if (!nextPoint(pos, carry + window)) return false;
+        }
+
+        ptr = data + (pos - carry - carried);
+        carried = 0;
+    }
+
+    while (ptr < end && static_cast<uint32_t>(route.getPointCount()) < pointCount)
+    {
+        size_t left = end - ptr;
+        if (left < ROUTE_MAX_POINT_SIZE && !last)
+        {
+            // Точка может продолжиться в следующем фрагменте
+            memcpy(carry, ptr, left);
+            carried = left;
+            return true;
+        }
+
+        if (!nextPoint(ptr, end)) return false;
+    }
+
+    return true;
+}
+
+bool RouteStreamDecoder::finishPayload()
+{
+    if (static_cast<uint32_t>(route.getPointCount()) != pointCount) return false;
+    if (!legacy && crc != header.crc) return false;
+
+    stage = Stage::Suffix;
+    if (protector.suffixSize() == 0)
+    {
+        if (!stream->finish(nullptr)) return false;
+        stage = Stage::Done;
+    }
+
+    return true;
+}
+
+long RouteStreamDecoder::fail()
+{
+    stage = Stage::Failed;
+    route.clear();
+    return -1;
+}
+
+bool RouteStreamDecoder::done() const
+{
+    return stage == Stage::Done;
+}
+
+bool RouteStreamDecoder::failed() const
+{
+    return stage == Stage::Failed;
+}
+
+size_t RouteStreamDecoder::messageSize() const
+{
+    return totalSize;
+}
@@ -11,7 +11,7 @@ void missionCountPack(mavlink_message_t &msg, int count)
     mavlink_msg_mission_count_encode(255, MAV_COMP_ID_ONBOARD_COMPUTER, &msg, &m_count);
 }
 
-void missionWPTPack(mavlink_mission_item_t &wp, WGS84Coord coord, int seq)
+void missionWPTPack(mavlink_mission_item_t &wp, const WGS84CoordInt &coord, int seq)
 {
     wp.target_system = 1,
     wp.target_component = 1,
@@ -20,123 +20,408 @@ void missionWPTPack(mavlink_mission_item_t &wp, WGS84Coord coord, int seq)
     wp.command = 16;  //MAV_CMD_NAV_WAYPOINT
     wp.current = 0;
     wp.autocontinue = 1;
-    wp.x = coord.lat;  // latitude
-    wp.y = coord.lon;  // longitude
-    wp.z = coord.alt;  // altitude
+    wp.param1 = wp.param2 = wp.param3 = wp.param4 = 0.0f;
+    wp.x = static_cast<float>(coord.lat * 1e-7);  // latitude
+    wp.y = static_cast<float>(coord.lon * 1e-7);  // longitude
+    wp.z = coord.alt * 1e-3f;  // altitude
     wp.mission_type = MAV_MISSION_TYPE_MISSION;
 }
 
-void sendMavlinkMessage(InterfaceUDP &sitl, const mavlink_message_t& msg)
+void missionWPTIntPack(mavlink_mission_item_int_t &wp, const WGS84CoordInt &coord, int seq)
+{
+    wp.target_system = 1;
+    wp.target_component = 1;
+    wp.seq = seq;
+    wp.frame = MAV_FRAME_GLOBAL_RELATIVE_ALT_INT;
+    wp.command = MAV_CMD_NAV_WAYPOINT;
+    wp.current = 0;
+    wp.autocontinue = 1;
+    wp.param1 = wp.param2 = wp.param3 = wp.param4 = 0.0f;
+    wp.x = coord.lat;  // latitude * 1e7, без перевода во float
+    wp.y = coord.lon;  // longitude * 1e7
+    wp.z = coord.alt * 1e-3f;  // altitude
+    wp.mission_type = MAV_MISSION_TYPE_MISSION;
+}
+
+void sendMavlinkMessage(InterfaceUDP &sitl, MavlinkChannel &channel, const mavlink_message_t& msg)
 {
     uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t len = mavlink_msg_to_send_buffer(buffer, &msg);
-    
+    uint16_t len = channel.encode(msg, buffer);
+    if (len == 0)
+    {
+        std::cerr << "Unknown MAVLink message " << msg.msgid << std::endl;
+        return;
+    }
+
     sitl.sendTo(buffer, len);
 }
 
-void Do_SetWayPoints(InterfaceUDP &sitl, WGS84Coord* coords, int count) 
+// Обмен с автопилотом до завершения MissionUploader / MissionDownloader
+template <typename Transfer>
+static void runTransfer(InterfaceUDP &sitl, MavlinkChannel &channel, Transfer &transfer)
 {
-    mavlink_message_t msg;
-    mavlink_status_t status;
-    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    uint8_t buf[MAVLINK_DATAGRAM_MAX];
+    auto dispatcher = makeMavlinkDispatcher(mavlinkSubscribe(transfer));
 
-    count += 1;
+    while (transfer.active())
+    {
+        ssize_t n = sitl.recvUntil(buf, sizeof(buf), transfer.nextWakeup());
+        if (n < 0 && errno != ETIMEDOUT)
+        {
+            perror("Mission transfer");
+            transfer.cancel();
+            break;
+        }
 
-    mavlink_msg_mission_count_pack(255, MAV_COMP_ID_ONBOARD_COMPUTER, &msg, 1, 1, count, MAV_MISSION_TYPE_MISSION);
-    sendMavlinkMessage(sitl, msg);
+        // Датаграмма разбирается целиком, побайтно - только кадр, разрезанный между чтениями.
+        // Сообщение декодируется из кадра в буфере без копии в mavlink_message_t
+        const uint8_t* p = buf;
+        mavlink_frame_view_t frame;
+        while (n > 0 && channel.parse(p, buf + n, frame))
+            dispatcher.dispatch(frame);
 
-    bool finished = false;
+        transfer.poll();
+    }
+}
 
-    while (finished != true)
+// Общая часть загрузки миссии: точки запрашиваются у источника маршрута по индексу.
+// firstSeq >= 0 - частичная загрузка пунктов firstSeq .. lastSeq
+static MissionUploadResult uploadMission(InterfaceUDP &sitl, MavlinkChannel &channel, int count,
+                                         const std::function<bool(uint32_t, WGS84CoordInt&)> &pointAt,
+                                         std::chrono::milliseconds timeout, int firstSeq = -1, int lastSeq = -1)
+{
+    // Счётчик пунктов в MISSION_COUNT 16-битный
+    if (count < 0 || count >= UINT16_MAX)
     {
-        ssize_t n = sitl.recvFrom(buf, sizeof(buf));
-        if (n <= 0) continue;
+        std::cerr << "Mission too long: " << count << " points" << std::endl;
+        return MissionUploadResult();
+    }
+
+    MissionTransferSettings settings;
+    settings.deadline = timeout;
+
+    MissionUploader uploader([&](const mavlink_message_t &out) { sendMavlinkMessage(sitl, channel, out); }, settings);
+
+    // Пункт 0 - точка дома, за ней точки маршрута. Пункт отправляется в том варианте,
+    // который запросил автопилот: MISSION_ITEM только в ответ на устаревший MISSION_REQUEST
+    auto itemAt = [&](uint16_t seq, MissionItemFormat format, mavlink_message_t &item) {
+        WGS84CoordInt point;
+        if (!pointAt(seq == 0 ? 0 : seq - 1, point))
+            return false;
 
-        for (ssize_t i = 0; i < n; ++i) 
+        if (format == MissionItemFormat::Int)
         {
-            if (mavlink_parse_char(MAVLINK_COMM_0, buf[i], &msg, &status)) 
-            {
-                switch (msg.msgid)
-                {
-                case MAVLINK_MSG_ID_MISSION_REQUEST:
-                {
-                    mavlink_mission_request_int_t req;
-                    mavlink_msg_mission_request_int_decode(&msg, &req);
-                    uint16_t seq = req.seq;
-                    mavlink_mission_item_t wp;
-
-                    std::cout << seq << "\n";
-
-                    if (seq == 0)
-                    {
-                        missionWPTPack(wp, coords[seq], seq);
-                        mavlink_msg_mission_item_encode(255, 191, &msg, &wp);
-                        sendMavlinkMessage(sitl, msg);
-                        break;
-                    }
-
-                    missionWPTPack(wp, coords[seq - 1], seq);
-                    mavlink_msg_mission_item_encode(255, 191, &msg, &wp);
-                    sendMavlinkMessage(sitl, msg);
-                    break;
-                }
-                case MAVLINK_MSG_ID_MISSION_ACK: 
-                {
-                    mavlink_mission_ack_t ack;
-                    mavlink_msg_mission_ack_decode(&msg, &ack);
-
-                    if (ack.type == MAV_MISSION_ACCEPTED)
-                    {
-                        std::cout << "Mission uploaded successfully (ACCEPTED)." << std::endl;
-                        mavlink_msg_mission_set_current_pack(255, 191, &msg, 1, 1, 0);
-                        sendMavlinkMessage(sitl, msg);
-
-                        mavlink_msg_command_long_pack(255, 191, &msg, 1, 1, 300, 0, 0.0f, 0, 0, 0, 0, 0, 0); // MAV_CMD_MISSION_START = 300
-                        sendMavlinkMessage(sitl, msg);
-                    }
-                    else
-                        std::cerr << "Mission not accepted, type=" << static_cast<int>(ack.type) << std::endl;
-                    finished = true;
-
-                    break;
-                }
-                default: break;
-                }
-            }
+            mavlink_mission_item_int_t wp;
+            missionWPTIntPack(wp, point, seq);
+            mavlink_msg_mission_item_int_encode(settings.systemId, settings.componentId, &item, &wp);
         }
+        else
+        {
+            mavlink_mission_item_t wp;
+            missionWPTPack(wp, point, seq);
+            mavlink_msg_mission_item_encode(settings.systemId, settings.componentId, &item, &wp);
+        }
+        return true;
+    };
+
+    std::future<MissionUploadResult> done = firstSeq < 0
+        ? uploader.start(static_cast<uint16_t>(count + 1), itemAt)
+        : uploader.startPartial(static_cast<uint16_t>(firstSeq), static_cast<uint16_t>(lastSeq), itemAt);
+
+    runTransfer(sitl, channel, uploader);
+
+    MissionUploadResult result = done.get();
+    std::cout << "Mission upload: " << result.duration.count() << " ms, " << result.retransmits << " retransmits, "
+              << result.duplicates << " duplicate requests, " << result.floatItems << " float items" << std::endl;
+
+    if (!result.accepted)
+        std::cerr << "Mission not accepted, type=" << static_cast<int>(result.ackType)
+                  << (result.timedOut ? " (timeout)" : "") << std::endl;
+    else if (firstSeq >= 0)
+        std::cout << "Mission items " << firstSeq << ".." << lastSeq << " updated (ACCEPTED)." << std::endl;
+    else
+        std::cout << "Mission uploaded successfully (ACCEPTED)." << std::endl;
+
+    return result;
+}
+
+static void startMission(InterfaceUDP &sitl, MavlinkChannel &channel)
+{
+    mavlink_message_t msg;
+
+    mavlink_msg_mission_set_current_pack(255, 191, &msg, 1, 1, 0);
+    sendMavlinkMessage(sitl, channel, msg);
+
+    mavlink_msg_command_long_pack(255, 191, &msg, 1, 1, 300, 0, 0.0f, 0, 0, 0, 0, 0, 0); // MAV_CMD_MISSION_START = 300
+    sendMavlinkMessage(sitl, channel, msg);
+}
+
+// Чтение пунктов с автопилота: вся миссия (firstSeq < 0) или пункты firstSeq .. lastSeq
+static MissionDownloadResult downloadMission(InterfaceUDP &sitl, MavlinkChannel &channel,
+                                             std::chrono::milliseconds timeout, int firstSeq = -1, int lastSeq = -1)
+{
+    MissionTransferSettings settings;
+    settings.deadline = timeout;
+
+    MissionDownloader downloader([&](const mavlink_message_t &out) { sendMavlinkMessage(sitl, channel, out); }, settings);
+
+    std::future<MissionDownloadResult> done = firstSeq < 0
+        ? downloader.start()
+        : downloader.startRange(static_cast<uint16_t>(firstSeq), static_cast<uint16_t>(lastSeq));
+
+    runTransfer(sitl, channel, downloader);
+
+    MissionDownloadResult result = done.get();
+    std::cout << "Mission readback: " << result.items.size() << " items, " << result.duration.count() << " ms, "
+              << result.retransmits << " retransmits" << std::endl;
+    return result;
+}
+
+// Вся миссия одним файлом @MISSION/mission.dat по MAVLink FTP
+static bool ftpUploadMission(InterfaceUDP &sitl, MavlinkChannel &channel, const WGS84CoordInt* coords, int count,
+                             std::chrono::milliseconds timeout)
+{
+    std::vector<mavlink_mission_item_int_t> items(count + 1);
+    for (int seq = 0; seq <= count; ++seq)
+        missionWPTIntPack(items[seq], coords[seq == 0 ? 0 : seq - 1], seq);
+
+    std::vector<uint8_t> file;
+    encodeMissionFile(items.data(), items.size(), file);
+
+    MissionTransferSettings settings;
+    settings.deadline = timeout;
+
+    MavlinkFtpClient ftp([&](const mavlink_message_t &out) { sendMavlinkMessage(sitl, channel, out); }, settings);
+    std::future<MavlinkFtpResult> done = ftp.startWrite(MISSION_FILE_PATH, std::move(file));
+    runTransfer(sitl, channel, ftp);
+
+    MavlinkFtpResult result = done.get();
+    std::cout << "Mission FTP upload: " << items.size() << " items, " << result.duration.count() << " ms, "
+              << result.retransmits << " retransmits" << (result.ok ? "" : " (failed)") << std::endl;
+    return result.ok;
+}
+
+static MissionDownloadResult ftpDownloadMission(InterfaceUDP &sitl, MavlinkChannel &channel,
+                                                std::chrono::milliseconds timeout)
+{
+    MissionTransferSettings settings;
+    settings.deadline = timeout;
+
+    MavlinkFtpClient ftp([&](const mavlink_message_t &out) { sendMavlinkMessage(sitl, channel, out); }, settings);
+    std::future<MavlinkFtpResult> done = ftp.startRead(MISSION_FILE_PATH);
+    runTransfer(sitl, channel, ftp);
+
+    MavlinkFtpResult file = done.get();
+
+    MissionDownloadResult result;
+    result.duration = file.duration;
+    result.retransmits = file.retransmits;
+    result.complete = file.ok && decodeMissionFile(file.data.data(), file.data.size(), result.items);
+
+    std::cout << "Mission FTP readback: " << result.items.size() << " items, " << result.duration.count() << " ms, "
+              << result.retransmits << " retransmits" << (result.complete ? "" : " (failed)") << std::endl;
+    return result;
+}
+
+// Вся миссия читается файлом, если автопилот умеет FTP, иначе (и при ошибке FTP) - по пунктам
+static MissionDownloadResult readMission(InterfaceUDP &sitl, MavlinkChannel &channel, bool useFtp,
+                                         std::chrono::milliseconds timeout, int firstSeq = -1, int lastSeq = -1)
+{
+    if (useFtp && firstSeq < 0)
+    {
+        MissionDownloadResult result = ftpDownloadMission(sitl, channel, timeout);
+        if (result.complete)
+            return result;
     }
-} 
+    return downloadMission(sitl, channel, timeout, firstSeq, lastSeq);
+}
+
+// Проверка загрузки чтением: пункты на автопилоте совпадают с отправленными точками
+static bool verifyMission(InterfaceUDP &sitl, MavlinkChannel &channel, const WGS84CoordInt* coords, int count,
+                          int32_t tolerance, bool useFtp, std::chrono::milliseconds timeout, int firstSeq = -1, int lastSeq = -1)
+{
+    MissionDownloadResult readback = readMission(sitl, channel, useFtp, timeout, firstSeq, lastSeq);
+    if (!readback.complete)
+        return false;
+
+    if (firstSeq < 0 && readback.items.size() != static_cast<size_t>(count) + 1)
+        return false;
 
-void waitHeartBeat(InterfaceUDP &sitl)
+    return MissionCache::itemsMatch(readback.items.data(), readback.items.size(), readback.first,
+                                    coords, count, tolerance);
+}
+
+bool Do_QueryFtpSupport(InterfaceUDP &sitl, MavlinkChannel &channel, std::chrono::milliseconds timeout)
 {
     mavlink_message_t msg;
-    mavlink_status_t status;
-    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    uint8_t buf[MAVLINK_DATAGRAM_MAX];
+
+    mavlink_msg_command_long_pack(255, 191, &msg, 1, 1, MAV_CMD_REQUEST_MESSAGE, 0,
+                                  MAVLINK_MSG_ID_AUTOPILOT_VERSION, 0, 0, 0, 0, 0, 0);
+    sendMavlinkMessage(sitl, channel, msg);
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
 
-    while (true) 
+    bool received = false;
+    uint64_t capabilities = 0;
+    auto dispatcher = makeMavlinkDispatcher(mavlinkOn<mavlink_autopilot_version_t>(
+        [&](const mavlink_autopilot_version_t &version) {
+            received = true;
+            capabilities = version.capabilities;
+        }));
+
+    while (!received)
+    {
+        ssize_t n = sitl.recvUntil(buf, sizeof(buf), deadline);
+        if (n < 0)
+        {
+            std::cout << "AUTOPILOT_VERSION not received, MAVLink FTP disabled" << std::endl;
+            return false;
+        }
+
+        const uint8_t* p = buf;
+        mavlink_frame_view_t frame;
+        while (!received && channel.parse(p, buf + n, frame))
+            dispatcher.dispatch(frame);
+    }
+
+    bool ftp = (capabilities & MAV_PROTOCOL_CAPABILITY_FTP) != 0;
+    std::cout << "MAVLink FTP " << (ftp ? "supported" : "not supported") << std::endl;
+    return ftp;
+}
+
+bool Do_ReadMission(InterfaceUDP &sitl, MavlinkChannel &channel, MissionCache &cache, bool useFtp,
+                    std::chrono::milliseconds timeout)
+{
+    MissionDownloadResult result = readMission(sitl, channel, useFtp, timeout);
+    if (!result.complete)
+    {
+        cache.clear();
+        return false;
+    }
+
+    if (!cache.assignItems(result.items.data(), result.items.size()))
+    {
+        std::cout << "Mission on vehicle was not made by us, next upload is full" << std::endl;
+        return true;
+    }
+
+    std::cout << "Mission on vehicle: " << cache.size() << " points, crc " << std::hex << cache.getHash()
+              << std::dec << std::endl;
+    return true;
+}
+
+bool Do_UpdateWayPoints(InterfaceUDP &sitl, MavlinkChannel &channel, const WGS84CoordInt* coords, int count,
+                        MissionCache &cache, bool useFtp, std::chrono::milliseconds timeout)
+{
+    if (count < 0)
+        return false;
+
+    // Тот же маршрут уже на автопилоте: ни загрузки, ни перезапуска миссии
+    if (cache.matches(coords, count))
     {
-        ssize_t n = sitl.recvFrom(buf, sizeof(buf));
-        if (n <= 0)
-            continue;
+        std::cout << "Mission unchanged (crc " << std::hex << cache.getHash() << std::dec << "), upload skipped"
+                  << std::endl;
+        return true;
+    }
+
+    auto pointAt = [&](uint32_t index, WGS84CoordInt &point) {
+        if (index >= static_cast<uint32_t>(count)) return false;
+        point = coords[index];
+        return true;
+    };
+
+    int firstSeq = -1;
+    int lastSeq = -1;
+
+    // Число пунктов частичной загрузкой не меняется
+    if (cache.known() && cache.size() == static_cast<size_t>(count))
+    {
+        const std::vector<WGS84CoordInt> &uploaded = cache.getPoints();
+
+        int first = 0;
+        while (coords[first] == uploaded[first])
+            ++first;
 
-        for (ssize_t i = 0; i < n; ++i) 
+        int last = count - 1;
+        while (coords[last] == uploaded[last])
+            --last;
+
+        // Точка i - пункт i + 1; точка 0 дублируется пунктом 0 (дом)
+        firstSeq = first == 0 ? 0 : first + 1;
+        lastSeq = last + 1;
+    }
+
+    // Большая миссия целиком уходит одним файлом; если FTP не сработал - по пунктам
+    bool viaFtp = false;
+    if (firstSeq < 0 && useFtp && count >= MISSION_FTP_MIN_POINTS)
+    {
+        viaFtp = ftpUploadMission(sitl, channel, coords, count, timeout);
+        if (!viaFtp)
+            std::cerr << "Mission FTP upload failed, using mission protocol" << std::endl;
+    }
+
+    // При неудаче состояние автопилота неизвестно - следующая загрузка будет полной
+    int32_t tolerance = 0;
+    if (!viaFtp)
+    {
+        MissionUploadResult upload = uploadMission(sitl, channel, count, pointAt, timeout, firstSeq, lastSeq);
+        if (!upload.accepted)
         {
-            if (mavlink_parse_char(MAVLINK_COMM_0, buf[i], &msg, &status)) 
-            {
-                if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT)
-                {
-                    std::cout << "Heartbeat getted\n";
-                    return;
-                }
-            }
+            cache.clear();
+            return false;
         }
+        if (upload.floatItems > 0)
+            tolerance = MissionCache::FLOAT_ITEM_TOLERANCE;
     }
+
+    if (!verifyMission(sitl, channel, coords, count, tolerance, useFtp, timeout, firstSeq, lastSeq))
+    {
+        std::cerr << "Mission readback does not match the uploaded route" << std::endl;
+        cache.clear();
+        return false;
+    }
+
+    cache.assign(coords, count);
+
+    if (firstSeq < 0)
+        startMission(sitl, channel);
+    return true;
 }
 
-void sendImage(InterfaceTCPClient tmp)
+bool waitHeartBeat(InterfaceUDP &sitl, MavlinkChannel &channel, std::chrono::milliseconds timeout)
 {
-    while (!tmp.ConnectToServer())
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint8_t buf[MAVLINK_DATAGRAM_MAX];
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    bool received = false;
+    auto dispatcher = makeMavlinkDispatcher(
+        mavlinkOn<mavlink_heartbeat_t>([&](const mavlink_heartbeat_t &) { received = true; }));
+
+    while (!received) 
+    {
+        ssize_t n = sitl.recvUntil(buf, sizeof(buf), deadline);
+        if (n < 0)
+        {
+            if (errno == ETIMEDOUT)
+                std::cerr << "Heartbeat timeout" << std::endl;
+            return false;
+        }
+
+        const uint8_t* p = buf;
+        mavlink_frame_view_t frame;
+        while (!received && channel.parse(p, buf + n, frame))
+            dispatcher.dispatch(frame);
+    }
+
+    std::cout << "Heartbeat getted\n";
+    return true;
+}
+
+void sendImage(InterfaceTCPClient &tmp)
+{
+    while (!tmp.waitConnected(std::chrono::seconds(1))) {}
 
     CameraV4L2 cam;
     if (!cam.openDevice() || !cam.initDevice(N_HD) || !cam.startCapturing()) 
@@ -148,20 +433,30 @@ void sendImage(InterfaceTCPClient tmp)
     int n = 0;
     uint8_t* image;
 
+    PayloadProtector& protector = payloadProtector();
+    std::vector<unsigned char> message;
+    ImageHeader header;
+
     while (true)
     {
         bool res = cam.getFrame(image, n);
 
         if (n > 0)
         {
-            unsigned char* data = new unsigned char[sizeof(int)];
-            memcpy(data, &n, sizeof(int));
+            // Кадр на проводе: [ImageHeader][защищённое сообщение]
+            header.size = static_cast<uint32_t>(protector.overhead() + n);
+            header.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            message.resize(wireSize<ImageHeader>() + header.size);
 
-            tmp.sendData(data, sizeof(int));
-            tmp.sendData(image, n);
+            unsigned char* sealed = wireEncode(header, message.data());
+            memcpy(sealed + protector.prefixSize(), image, n);
+            protector.seal(sealed, n);
 
-            delete[] data;
-            data = nullptr;
+            // Без соединения или при полном буфере сокета кадр отбрасывается, камера не ждёт;
+            // переподключение идёт в фоне
+            tmp.sendData(message.data(), message.size(), true);
+            header.sequence++;
 
             delete[] image;
             image = nullptr;
@@ -171,20 +466,74 @@ void sendImage(InterfaceTCPClient tmp)
     }
 }
 
-void recvCoords(InterfaceTCPServer tmp)
+// Подготовка принятого маршрута к выгрузке. false - маршрут отклонён
+static bool prepareRoute(FlyPlaneData& route, const Geofence& fence)
 {
+    // Каждая точка - отдельный обмен с автопилотом, почти лежащие на прямой не нужны
+    int received = route.getPointCount();
+    SimplifyResult simplified = simplifyRoute(route, ROUTE_SIMPLIFY_TOLERANCE_M);
+    if (simplified.removed > 0)
+        std::cout << "Route simplified: " << received << " -> " << route.getPointCount()
+                  << " points, max deviation " << simplified.maxDeviation << " m" << std::endl;
+
+    std::vector<GeofenceViolation> violations = fence.check(route);
+    if (!violations.empty())
+    {
+        for (const GeofenceViolation& violation : violations)
+        {
+            if (violation.polygon != GEOFENCE_INVALID)
+                std::cerr << "Geofence: leg " << violation.leg << " enters zone " << violation.polygon << std::endl;
+        }
+        std::cerr << "Route rejected" << std::endl;
+        return false;
+    }
+
+    RouteSoA soa;
+    RouteMetrics metrics;
+    soa.assign(route);
+    computeRouteMetrics(soa, ROUTE_CRUISE_SPEED_MS, metrics);
+    std::cout << "Route: " << metrics.totalDistance << " m, about " << metrics.flightTime
+              << " s, climb up to " << metrics.maxClimbRate << " m/s, descent up to "
+              << metrics.maxDescentRate << " m/s" << std::endl;
+
+    return true;
+}
+
+void recvCoords(InterfaceTCPServer &tmp)
+{
+    // Запретные зоны загружаются один раз, индекс строится сразу
+    Geofence fence;
+    if (fence.loadFile(GEOFENCE_FILE))
+        std::cout << "Geofence: " << fence.size() << " zones" << std::endl;
+
+    // Своё состояние разбора у канала автопилота: другие потоки и каналы его не трогают
     InterfaceUDP Autopilot(MAVLINK_IP, MAVLINK_PORT);
-    waitHeartBeat(Autopilot);
+    MavlinkChannel AutopilotLink;
+    while (!waitHeartBeat(Autopilot, AutopilotLink))
+    {
+        if (Autopilot.isCancelled()) return;
+    }
+
+    // Маршрут декодируется прямо из сокета в route, память под точки переиспользуется
+    FlyPlaneData route;
+
+    // Миссия на автопилоте: такой же маршрут не загружается, изменённый - только разницей
+    bool ftp = Do_QueryFtpSupport(Autopilot, AutopilotLink);
+
+    MissionCache cache;
+    Do_ReadMission(Autopilot, AutopilotLink, cache, ftp);
 
     while (true)
     {
-        FlyPlaneData Data;
-        int length = tmp.readFlyPlaneData(Data);
+        int length = tmp.readFlyPlaneData(route);
 
         if (length > 0)
         {
-            Do_SetWayPoints(Autopilot, Data.getCoords(), Data.getPointCount());
             std::cout << "Getted coords\n";
+
+            if (prepareRoute(route, fence)
+                && !Do_UpdateWayPoints(Autopilot, AutopilotLink, route.getPoints(), route.getPointCount(), cache, ftp))
+                std::cerr << "Mission upload failed" << std::endl;
         }
 
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -196,8 +545,8 @@ int UAV_func()
     InterfaceTCPServer CoordsRecv("0.0.0.0", TEST_PORT + 1);
     InterfaceTCPClient ImageSend(MAIN_IP, MAIN_PORT);
 
-    std::thread sendThread(sendImage, ImageSend);
-    std::thread recvThread(recvCoords,  CoordsRecv);
+    std::thread sendThread(sendImage, std::ref(ImageSend));
+    std::thread recvThread(recvCoords,  std::ref(CoordsRecv));
 
     sendThread.join();
     recvThread.join();
@@ -0,0 +1,137 @@
+#include "UDPReceiverGroup.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <linux/filter.h>
+
+UDPReceiverGroup::UDPReceiverGroup(int port, int workers, SteeringMode steering) : port(port), steering(steering)
+{
+    if (workers < 1) workers = 1;
+
+    // Индекс сокета в группе ядра совпадает с порядком bind, т.е. с индексом в sockets
+    for (int i = 0; i < workers; ++i)
+        sockets.emplace_back(new InterfaceUDP("0.0.0.0", port, true));
+
+    if (steering != SteeringMode::Kernel && !attachSteering())
+        fprintf(stderr, "BPF steering unavailable, falling back to kernel hash\n");
+}
+
+UDPReceiverGroup::~UDPReceiverGroup()
+{
+    stop();
+}
+
+bool UDPReceiverGroup::attachSteering()
+{
+    const uint32_t n = static_cast<uint32_t>(sockets.size());
+
+    // Программа выполняется над полезной нагрузкой UDP и возвращает индекс сокета
+    std::vector<sock_filter> code;
+    if (steering == SteeringMode::SourceAddress)
+    {
+        code = {
+            BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF + 12)),  // A = saddr IPv4
+            BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, n),
+            BPF_STMT(BPF_RET | BPF_A, 0),
+        };
+    }
+    else
+    {
+        code = {
+            BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),                 // A = STX
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0xFD, 0, 2),
+            BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 5),                 // v2: sysid
+            BPF_JUMP(BPF_JMP | BPF_JA, 1, 0, 0),
+            BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 3),                 // v1: sysid
+            BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, n),
+            BPF_STMT(BPF_RET | BPF_A, 0),
+        };
+    }
+
+    sock_fprog prog;
+    prog.len = static_cast<unsigned short>(code.size());
+    prog.filter = code.data();
+
+    if (setsockopt(sockets[0]->handler, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0)
+    {
+        perror("SO_ATTACH_REUSEPORT_CBPF");
+        return false;
+    }
+
+    return true;
+}
+
+bool UDPReceiverGroup::start(Handler newHandler, bool pinThreads)
+{
+    if (running.exchange(true)) return false;
+
+    handler = std::move(newHandler);
+    unsigned cores = std::thread::hardware_concurrency();
+
+    for (int i = 0; i < size(); ++i)
+    {
+        sockets[i]->resetCancel();
+        threads.emplace_back(&UDPReceiverGroup::workerLoop, this, i);
+
+        if (pinThreads && cores > 0)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(i % cores, &set);
+            if (pthread_setaffinity_np(threads.back().native_handle(), sizeof(set), &set) != 0)
+                fprintf(stderr, "Failed to pin UDP worker %d\n", i);
+        }
+    }
+
+    return true;
+}
+
+void UDPReceiverGroup::stop()
+{
+    if (!running.exchange(false)) return;
+
+    for (auto& sock : sockets)
+        sock->cancel();
+
+    for (auto& thread : threads)
+        if (thread.joinable()) thread.join();
+
+    threads.clear();
+}
+
+int UDPReceiverGroup::size() const
+{
+    return static_cast<int>(sockets.size());
+}
+
+InterfaceUDP& UDPReceiverGroup::socket(int worker)
+{
+    return *sockets[worker];
+}
+
+void UDPReceiverGroup::workerLoop(int worker)
+{
+    InterfaceUDP& sock = *sockets[worker];
+
+    // Буферы принадлежат потоку и не разделяются с другими worker
+    std::vector<uint8_t> storage(UDP_BATCH_MAX * 2048);
+    UDPDatagram batch[UDP_BATCH_MAX];
+    for (int i = 0; i < UDP_BATCH_MAX; ++i)
+    {
+        batch[i].data = storage.data() + i * 2048;
+        batch[i].capacity = 2048;
+    }
+
+    while (running)
+    {
+        if (!sock.waitReadable(std::chrono::steady_clock::now() + std::chrono::seconds(1)))
+        {
+            if (errno == ECANCELED) break;
+            continue;
+        }
+
+        int received = sock.recvBatch(batch, UDP_BATCH_MAX, MSG_DONTWAIT);
+        for (int i = 0; i < received; ++i)
+            handler(worker, sock, batch[i]);
+    }
+}